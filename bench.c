@@ -1,5 +1,19 @@
+#include <pthread.h>
+#include <stdatomic.h>
+
 #include <Armel/armel.h>
 #include <Armel/armel_bench.h>
+#include <Armel/armel_ring.h>
+#include <Armel/armel_mirror.h>
+#include <Armel/armel_mpsc.h>
+#include <Armel/armel_pool.h>
+#include <Armel/armel_ref.h>
+#include <Armel/armel_handle.h>
+#include <Armel/armel_bitmap.h>
+#include <Armel/armel_buddy.h>
+#include <Armel/armel_file.h>
+#include <Armel/armel_output.h>
+#include <Armel/armel_prefault.h>
 
 #define N 10000000
 
@@ -165,6 +179,949 @@ uint64_t bench_arl_array() {
     return (end - start) / N;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK SPSC RING (ONE PRODUCER THREAD -> ONE CONSUMER THREAD, FIFO RELEASE)
+
+#define RING_N 1000000
+#define RING_RECORD 64
+#define QUEUE_SLOTS 4096
+
+// Baseline: malloc'd records passed through a bounded SPSC queue of pointers
+typedef struct {
+    _Alignas(64) _Atomic size_t head;
+    _Alignas(64) _Atomic size_t tail;
+    void* slots[QUEUE_SLOTS];
+} PtrQueue;
+
+static void* queue_consumer(void* arg) {
+    PtrQueue* q = arg;
+    volatile unsigned sink = 0;
+    size_t tail = 0;
+
+    for (size_t i = 0; i < RING_N; i++) {
+        while (atomic_load_explicit(&q->head, memory_order_acquire) == tail) {}
+        unsigned char* rec = q->slots[tail % QUEUE_SLOTS];
+        sink += rec[0] + rec[RING_RECORD - 1];
+        free(rec);
+        atomic_store_explicit(&q->tail, ++tail, memory_order_release);
+    }
+    return NULL;
+}
+
+uint64_t bench_malloc_queue() {
+    static PtrQueue q;
+    atomic_init(&q.head, 0);
+    atomic_init(&q.tail, 0);
+    pthread_t consumer;
+
+    uint64_t start = arl_now_ns();
+    pthread_create(&consumer, NULL, queue_consumer, &q);
+
+    size_t head = 0;
+    for (size_t i = 0; i < RING_N; i++) {
+        unsigned char* rec = malloc(RING_RECORD);
+        memset(rec, (int)i, RING_RECORD);
+        while (head - atomic_load_explicit(&q.tail, memory_order_acquire) == QUEUE_SLOTS) {}
+        q.slots[head % QUEUE_SLOTS] = rec;
+        atomic_store_explicit(&q.head, ++head, memory_order_release);
+    }
+
+    pthread_join(consumer, NULL);
+    uint64_t end = arl_now_ns();
+    return (end - start) / RING_N;
+}
+
+static void* ring_consumer(void* arg) {
+    ArlRing* ring = arg;
+    volatile unsigned sink = 0;
+
+    for (size_t i = 0; i < RING_N; i++) {
+        unsigned char* rec;
+        while ((rec = arl_ring_peek(ring, NULL)) == NULL) {}
+        sink += rec[0] + rec[RING_RECORD - 1];
+        arl_ring_release(ring);
+    }
+    return NULL;
+}
+
+uint64_t bench_arl_ring() {
+    ArlRing ring;
+    arl_ring_new(&ring, QUEUE_SLOTS * (RING_RECORD + ARL_RING_HEADER));
+    pthread_t consumer;
+
+    uint64_t start = arl_now_ns();
+    pthread_create(&consumer, NULL, ring_consumer, &ring);
+
+    for (size_t i = 0; i < RING_N; i++) {
+        unsigned char* rec;
+        while ((rec = arl_ring_alloc(&ring, RING_RECORD)) == NULL) {}
+        memset(rec, (int)i, RING_RECORD);
+        arl_ring_commit(&ring);
+    }
+
+    pthread_join(consumer, NULL);
+    uint64_t end = arl_now_ns();
+    arl_ring_free(&ring);
+    return (end - start) / RING_N;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK BYTE STREAM (MIRRORED RING VS SPLIT COPIES AT THE WRAP POINT)
+
+#define STREAM_N 1000000
+#define STREAM_RING (64 * 1024)
+
+static unsigned char stream_msg[1500];
+
+// Baseline: a plain byte ring where writes and reads are split at the wrap point
+uint64_t bench_split_ring() {
+    volatile int sink = 0;
+    unsigned char* ring = malloc(STREAM_RING);
+    unsigned char out[1500];
+    size_t head = 0, tail = 0;
+
+    uint64_t start = arl_now_ns();
+
+    for (size_t i = 0; i < STREAM_N; i++) {
+        size_t len = 64 + (i * 7919) % 1400;
+        size_t at = head % STREAM_RING, first = STREAM_RING - at;
+        if (first >= len) {
+            memcpy(ring + at, stream_msg, len);
+        } else {
+            memcpy(ring + at, stream_msg, first);
+            memcpy(ring, stream_msg + first, len - first);
+        }
+        head += len;
+
+        at = tail % STREAM_RING;
+        first = STREAM_RING - at;
+        if (first >= len) {
+            memcpy(out, ring + at, len);
+        } else {
+            memcpy(out, ring + at, first);
+            memcpy(out + first, ring, len - first);
+        }
+        tail += len;
+        sink += out[len - 1];
+    }
+
+    uint64_t end = arl_now_ns();
+    free(ring);
+    return (end - start) / STREAM_N;
+}
+
+uint64_t bench_arl_mirror() {
+    volatile int sink = 0;
+    ArlMirror ring;
+    arl_mirror_new(&ring, STREAM_RING);
+    unsigned char out[1500];
+
+    uint64_t start = arl_now_ns();
+
+    for (size_t i = 0; i < STREAM_N; i++) {
+        size_t len = 64 + (i * 7919) % 1400, avail;
+        memcpy(arl_mirror_reserve(&ring, len), stream_msg, len);
+        arl_mirror_commit(&ring, len);
+
+        memcpy(out, arl_mirror_peek(&ring, &avail), len);
+        arl_mirror_consume(&ring, len);
+        sink += out[len - 1];
+    }
+
+    uint64_t end = arl_now_ns();
+    arl_mirror_free(&ring);
+    return (end - start) / STREAM_N;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK MPSC QUEUE (1-32 PRODUCER THREADS -> ONE CONSUMER)
+
+#define MPSC_N 200000
+#define MPSC_PAYLOAD 48
+
+static int mpsc_producers = 1;
+
+// Baseline: same intrusive queue, nodes malloc'd by producers and freed by the consumer
+typedef struct MallocNode {
+    _Atomic(struct MallocNode*) next;
+    unsigned char payload[MPSC_PAYLOAD];
+} MallocNode;
+
+typedef struct {
+    _Alignas(64) _Atomic(MallocNode*) head;
+    _Alignas(64) MallocNode* tail;
+    MallocNode stub;
+} MallocQueue;
+
+static MallocQueue malloc_queue;
+
+static void malloc_queue_push(MallocQueue* q, MallocNode* node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    MallocNode* prev = atomic_exchange_explicit(&q->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+static MallocNode* malloc_queue_pop(MallocQueue* q) {
+    MallocNode* tail = q->tail;
+    MallocNode* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &q->stub) {
+        if (next == NULL) return NULL;
+        q->tail = tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next == NULL) {
+        if (tail != atomic_load_explicit(&q->head, memory_order_acquire)) return NULL;
+        malloc_queue_push(q, &q->stub);
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+        if (next == NULL) return NULL;
+    }
+    q->tail = next;
+    return tail;
+}
+
+static void* malloc_producer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < MPSC_N / mpsc_producers; i++) {
+        MallocNode* node = malloc(sizeof(MallocNode));
+        memset(node->payload, i, MPSC_PAYLOAD);
+        malloc_queue_push(&malloc_queue, node);
+    }
+    return NULL;
+}
+
+uint64_t bench_malloc_mpsc() {
+    pthread_t threads[32];
+    int total = (MPSC_N / mpsc_producers) * mpsc_producers;
+    volatile int sink = 0;
+
+    atomic_init(&malloc_queue.stub.next, NULL);
+    atomic_init(&malloc_queue.head, &malloc_queue.stub);
+    malloc_queue.tail = &malloc_queue.stub;
+
+    uint64_t start = arl_now_ns();
+    for (int i = 0; i < mpsc_producers; i++) {
+        pthread_create(&threads[i], NULL, malloc_producer, NULL);
+    }
+    for (int received = 0; received < total;) {
+        MallocNode* node = malloc_queue_pop(&malloc_queue);
+        if (node == NULL) continue;
+        sink += node->payload[0];
+        free(node);
+        received++;
+    }
+    for (int i = 0; i < mpsc_producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t end = arl_now_ns();
+    return (end - start) / total;
+}
+
+static ArlMpsc arl_queue;
+
+static void* arl_producer(void* arg) {
+    ArlMpscProducer* me = arg;
+    for (int i = 0; i < MPSC_N / mpsc_producers; i++) {
+        unsigned char* payload = arl_mpsc_alloc(me, MPSC_PAYLOAD);
+        memset(payload, i, MPSC_PAYLOAD);
+        arl_mpsc_send(&arl_queue, payload);
+    }
+    return NULL;
+}
+
+uint64_t bench_arl_mpsc() {
+    pthread_t threads[32];
+    static ArlMpscProducer producers[32];
+    int total = (MPSC_N / mpsc_producers) * mpsc_producers;
+    volatile int sink = 0;
+
+    arl_mpsc_new(&arl_queue);
+    for (int i = 0; i < mpsc_producers; i++) {
+        arl_mpsc_producer_new(&arl_queue, &producers[i], 64 * ARL_KB);
+    }
+
+    uint64_t start = arl_now_ns();
+    for (int i = 0; i < mpsc_producers; i++) {
+        pthread_create(&threads[i], NULL, arl_producer, &producers[i]);
+    }
+    for (int received = 0; received < total;) {
+        unsigned char* payload = arl_mpsc_pop(&arl_queue, NULL);
+        if (payload == NULL) {
+            arl_mpsc_flush(&arl_queue);
+            continue;
+        }
+        sink += payload[0];
+        arl_mpsc_done(&arl_queue, payload);
+        received++;
+    }
+    for (int i = 0; i < mpsc_producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    uint64_t end = arl_now_ns();
+
+    for (int i = 0; i < mpsc_producers; i++) {
+        arl_mpsc_producer_free(&arl_queue, &producers[i]);
+    }
+    return (end - start) / total;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK CROSS-THREAD FREE (PRODUCER ALLOCATES, CONSUMER FREES)
+
+#define CHURN_N 1000000
+#define CHURN_OBJECT 64
+
+// Baseline: the pool's free list guarded by a mutex, shared by both threads
+typedef struct {
+    pthread_mutex_t lock;
+    ArlPoolSlot* free;
+    Armel* armel;
+} LockedPool;
+
+static void* locked_pool_alloc(LockedPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    ArlPoolSlot* slot = pool->free;
+    if (slot != NULL) {
+        pool->free = slot->next;
+    } else {
+        slot = arl_alloc(pool->armel, CHURN_OBJECT);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return slot;
+}
+
+static void locked_pool_free(LockedPool* pool, void* ptr) {
+    ArlPoolSlot* slot = ptr;
+    pthread_mutex_lock(&pool->lock);
+    slot->next = pool->free;
+    pool->free = slot;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+typedef struct {
+    PtrQueue* queue;
+    void (*release)(void* pool, void* ptr);
+    void* pool;
+} ChurnConsumer;
+
+static void* churn_consumer(void* arg) {
+    ChurnConsumer* c = arg;
+    volatile unsigned sink = 0;
+    size_t tail = 0;
+
+    for (size_t i = 0; i < CHURN_N; i++) {
+        while (atomic_load_explicit(&c->queue->head, memory_order_acquire) == tail) {}
+        unsigned char* obj = c->queue->slots[tail % QUEUE_SLOTS];
+        sink += obj[CHURN_OBJECT - 1];
+        c->release(c->pool, obj);
+        atomic_store_explicit(&c->queue->tail, ++tail, memory_order_release);
+    }
+    return NULL;
+}
+
+static uint64_t churn_run(ChurnConsumer* c, void* (*acquire)(void* pool)) {
+    static PtrQueue q;
+    atomic_init(&q.head, 0);
+    atomic_init(&q.tail, 0);
+    c->queue = &q;
+    pthread_t consumer;
+
+    uint64_t start = arl_now_ns();
+    pthread_create(&consumer, NULL, churn_consumer, c);
+
+    size_t head = 0;
+    for (size_t i = 0; i < CHURN_N; i++) {
+        unsigned char* obj = acquire(c->pool);
+        memset(obj, (int)i, CHURN_OBJECT);
+        while (head - atomic_load_explicit(&q.tail, memory_order_acquire) == QUEUE_SLOTS) {}
+        q.slots[head % QUEUE_SLOTS] = obj;
+        atomic_store_explicit(&q.head, ++head, memory_order_release);
+    }
+
+    pthread_join(consumer, NULL);
+    uint64_t end = arl_now_ns();
+    return (end - start) / CHURN_N;
+}
+
+static void* churn_malloc(void* pool) { (void)pool; return malloc(CHURN_OBJECT); }
+static void churn_free(void* pool, void* ptr) { (void)pool; free(ptr); }
+static void* churn_locked_alloc(void* pool) { return locked_pool_alloc(pool); }
+static void churn_locked_free(void* pool, void* ptr) { locked_pool_free(pool, ptr); }
+static void* churn_pool_alloc(void* pool) { return arl_pool_alloc(pool); }
+static void churn_pool_free(void* pool, void* ptr) { arl_pool_free_remote(pool, ptr); }
+
+uint64_t bench_malloc_churn() {
+    ChurnConsumer c = { NULL, churn_free, NULL };
+    return churn_run(&c, churn_malloc);
+}
+
+uint64_t bench_locked_pool_churn() {
+    Armel armel;
+    arl_new(&armel, ARL_MB);
+    LockedPool pool = { PTHREAD_MUTEX_INITIALIZER, NULL, &armel };
+    ChurnConsumer c = { NULL, churn_locked_free, &pool };
+
+    uint64_t ns = churn_run(&c, churn_locked_alloc);
+    arl_free(&armel);
+    return ns;
+}
+
+uint64_t bench_arl_pool_churn() {
+    Armel armel;
+    static ArlPool pool;
+    arl_new(&armel, ARL_MB);
+    arl_pool_new(&pool, &armel, CHURN_OBJECT);
+    ChurnConsumer c = { NULL, churn_pool_free, &pool };
+
+    uint64_t ns = churn_run(&c, churn_pool_alloc);
+    arl_free(&armel);
+    return ns;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK TREE LOOKUPS (8-BYTE POINTERS VS 32-BIT COMPRESSED REFERENCES)
+
+#define TREE_NODES (1 << 20)
+#define TREE_LOOKUPS 1000000
+
+typedef struct PtrNode {
+    uint32_t key;
+    struct PtrNode* left;
+    struct PtrNode* right;
+} PtrNode;                       // 24 bytes
+
+typedef struct {
+    uint32_t key;
+    arl_ref32 left;
+    arl_ref32 right;
+} RefNode;                       // 12 bytes
+
+static uint32_t tree_keys[TREE_NODES];
+
+static uint32_t tree_random(uint64_t* state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+static void tree_fill_keys(void) {
+    uint64_t state = 42;
+    for (int i = 0; i < TREE_NODES; i++) tree_keys[i] = tree_random(&state);
+}
+
+uint64_t bench_ptr_tree() {
+    static Armel armel;
+    static PtrNode* root = NULL;
+
+    if (root == NULL) {
+        tree_fill_keys();
+        arl_new_custom(&armel, TREE_NODES * sizeof(PtrNode) + ARL_KB, 8, ARL_NOFLAG);
+        for (int i = 0; i < TREE_NODES; i++) {
+            PtrNode* node = arl_make(&armel, PtrNode);
+            node->key = tree_keys[i];
+            node->left = node->right = NULL;
+            PtrNode** link = &root;
+            while (*link) link = node->key < (*link)->key ? &(*link)->left : &(*link)->right;
+            *link = node;
+        }
+    }
+
+    uint64_t state = 7;
+    volatile size_t found = 0;
+    uint64_t start = arl_now_ns();
+    for (int i = 0; i < TREE_LOOKUPS; i++) {
+        uint32_t key = tree_keys[tree_random(&state) % TREE_NODES];
+        PtrNode* node = root;
+        while (node && node->key != key) node = key < node->key ? node->left : node->right;
+        found += node != NULL;
+    }
+    uint64_t end = arl_now_ns();
+    return (end - start) / TREE_LOOKUPS;
+}
+
+uint64_t bench_ref_tree() {
+    static Armel armel;
+    static arl_ref32 root = ARL_REF_NULL;
+
+    if (root == ARL_REF_NULL) {
+        tree_fill_keys();
+        arl_new_custom(&armel, TREE_NODES * sizeof(RefNode) + ARL_KB, 4, ARL_NOFLAG);
+        for (int i = 0; i < TREE_NODES; i++) {
+            arl_ref32 ref = arl_alloc_ref(&armel, sizeof(RefNode));
+            RefNode* node = ARL_DEREF(&armel, RefNode, ref);
+            node->key = tree_keys[i];
+            node->left = node->right = ARL_REF_NULL;
+            arl_ref32* link = &root;
+            while (*link) {
+                RefNode* at = ARL_DEREF(&armel, RefNode, *link);
+                link = node->key < at->key ? &at->left : &at->right;
+            }
+            *link = ref;
+        }
+    }
+
+    uint64_t state = 7;
+    volatile size_t found = 0;
+    uint64_t start = arl_now_ns();
+    for (int i = 0; i < TREE_LOOKUPS; i++) {
+        uint32_t key = tree_keys[tree_random(&state) % TREE_NODES];
+        RefNode* node = ARL_DEREF(&armel, RefNode, root);
+        while (node && node->key != key) {
+            node = ARL_DEREF(&armel, RefNode, key < node->key ? node->left : node->right);
+        }
+        found += node != NULL;
+    }
+    uint64_t end = arl_now_ns();
+    return (end - start) / TREE_LOOKUPS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK ENTITY STORAGE (churn, then iteration over live objects)
+////////////////////////////////////////////////////////////////////////////////
+
+#define ENTITY_N (1 << 16)
+#define ENTITY_CHURN (1 << 20)
+#define ENTITY_PASSES 64
+
+typedef struct {
+    float x, y, vx, vy;
+    uint32_t id, flags;
+} Entity;
+
+static uint64_t entity_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void entity_init(Entity* e, uint32_t id) {
+    e->x = e->y = 0.0f;
+    e->vx = 1.0f;
+    e->vy = 0.5f;
+    e->id = id;
+    e->flags = 0;
+}
+
+// Pointer-based free-list pool, with an array of live pointers to iterate
+static uint64_t pool_entities(int iterate) {
+    Armel armel;
+    ArlPool pool;
+    arl_new(&armel, ARL_MB * 8);
+    arl_pool_new(&pool, &armel, sizeof(Entity));
+
+    Entity** live = malloc(ENTITY_N * sizeof(Entity*));
+    for (uint32_t i = 0; i < ENTITY_N; i++) {
+        live[i] = arl_pool_alloc(&pool);
+        entity_init(live[i], i);
+    }
+
+    uint64_t state = 42;
+    uint64_t start = arl_now_ns();
+    for (uint32_t i = 0; i < ENTITY_CHURN; i++) {
+        size_t at = entity_random(&state) % ENTITY_N;
+        arl_pool_free(&pool, live[at]);
+        live[at] = arl_pool_alloc(&pool);
+        entity_init(live[at], i);
+    }
+    uint64_t end = arl_now_ns();
+    uint64_t result = (end - start) / ENTITY_CHURN;
+
+    if (iterate) {
+        start = arl_now_ns();
+        for (int pass = 0; pass < ENTITY_PASSES; pass++) {
+            for (size_t i = 0; i < ENTITY_N; i++) {
+                live[i]->x += live[i]->vx;
+                live[i]->y += live[i]->vy;
+            }
+        }
+        end = arl_now_ns();
+        result = (end - start) * 1000 / ((uint64_t)ENTITY_PASSES * ENTITY_N);
+    }
+
+    free(live);
+    arl_free(&armel);
+    return result;
+}
+
+// Generational handles over a dense array
+static uint64_t handle_entities(int iterate) {
+    Armel armel;
+    ArlHandlePool pool;
+    arl_new(&armel, ARL_MB * 8);
+    arl_handle_pool_new(&pool, &armel, sizeof(Entity), ENTITY_N);
+
+    ArlHandle* live = malloc(ENTITY_N * sizeof(ArlHandle));
+    for (uint32_t i = 0; i < ENTITY_N; i++) {
+        live[i] = arl_handle_alloc(&pool);
+        entity_init(arl_handle_get(&pool, live[i]), i);
+    }
+
+    uint64_t state = 42;
+    uint64_t start = arl_now_ns();
+    for (uint32_t i = 0; i < ENTITY_CHURN; i++) {
+        size_t at = entity_random(&state) % ENTITY_N;
+        arl_handle_free(&pool, live[at]);
+        live[at] = arl_handle_alloc(&pool);
+        entity_init(arl_handle_get(&pool, live[at]), i);
+    }
+    uint64_t end = arl_now_ns();
+    uint64_t result = (end - start) / ENTITY_CHURN;
+
+    if (iterate) {
+        Entity* items = arl_handle_items(&pool);
+        start = arl_now_ns();
+        for (int pass = 0; pass < ENTITY_PASSES; pass++) {
+            for (size_t i = 0; i < pool.count; i++) {
+                items[i].x += items[i].vx;
+                items[i].y += items[i].vy;
+            }
+        }
+        end = arl_now_ns();
+        result = (end - start) * 1000 / ((uint64_t)ENTITY_PASSES * ENTITY_N);
+    }
+
+    free(live);
+    arl_free(&armel);
+    return result;
+}
+
+uint64_t bench_pool_entity_churn() { return pool_entities(0); }
+uint64_t bench_handle_entity_churn() { return handle_entities(0); }
+
+// Reported in picoseconds per object: a pass over 64K objects is too fast for ns/op
+uint64_t bench_pool_entity_iterate() { return pool_entities(1); }
+uint64_t bench_handle_entity_iterate() { return handle_entities(1); }
+
+////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK BLOCK REUSE (random frees, then allocate and fill)
+////////////////////////////////////////////////////////////////////////////////
+
+#define BLOCK_N (1 << 16)
+#define BLOCK_BATCH 4096
+#define BLOCK_ROUNDS 32
+#define BLOCK_SIZE 64
+#define BLOCK_EVICT (16 * ARL_MB)
+
+// Other work runs between frees and allocations: freed blocks are no longer cached
+static void block_evict() {
+    static volatile char* junk = NULL;
+    if (junk == NULL) junk = calloc(BLOCK_EVICT, 1);
+    for (size_t i = 0; i < BLOCK_EVICT; i += 64) junk[i] = junk[i] + 1;
+}
+
+uint64_t bench_pool_random_free() {
+    Armel armel;
+    ArlPool pool;
+    arl_new(&armel, ARL_MB * 16);
+    arl_pool_new(&pool, &armel, BLOCK_SIZE);
+
+    void** live = malloc(BLOCK_N * sizeof(void*));
+    for (int i = 0; i < BLOCK_N; i++) live[i] = arl_pool_alloc(&pool);
+
+    uint64_t state = 42;
+    uint64_t total = 0;
+    for (int round = 0; round < BLOCK_ROUNDS; round++) {
+        block_evict();
+        uint64_t start = arl_now_ns();
+        for (int i = 0; i < BLOCK_BATCH; i++) {
+            size_t at = entity_random(&state) % BLOCK_N;
+            if (live[at]) {
+                arl_pool_free(&pool, live[at]);
+                live[at] = NULL;
+            }
+        }
+        uint64_t end = arl_now_ns();
+        total += end - start;
+
+        block_evict();
+        start = arl_now_ns();
+        for (int i = 0; i < BLOCK_N; i++) {
+            if (live[i] == NULL) {
+                live[i] = arl_pool_alloc(&pool);
+                memset(live[i], i, BLOCK_SIZE);
+            }
+        }
+        end = arl_now_ns();
+        total += end - start;
+    }
+
+    free(live);
+    arl_free(&armel);
+    return total / ((uint64_t)BLOCK_ROUNDS * BLOCK_BATCH);
+}
+
+uint64_t bench_bitmap_random_free() {
+    Armel armel;
+    ArlBitmap pool;
+    arl_new(&armel, ARL_MB * 16);
+    arl_bitmap_new(&pool, &armel, BLOCK_SIZE, 0);
+
+    void** live = malloc(BLOCK_N * sizeof(void*));
+    for (int i = 0; i < BLOCK_N; i++) live[i] = arl_bitmap_alloc(&pool);
+
+    uint64_t state = 42;
+    uint64_t total = 0;
+    for (int round = 0; round < BLOCK_ROUNDS; round++) {
+        block_evict();
+        uint64_t start = arl_now_ns();
+        for (int i = 0; i < BLOCK_BATCH; i++) {
+            size_t at = entity_random(&state) % BLOCK_N;
+            if (live[at]) {
+                arl_bitmap_free(&pool, live[at]);
+                live[at] = NULL;
+            }
+        }
+        uint64_t end = arl_now_ns();
+        total += end - start;
+
+        block_evict();
+        start = arl_now_ns();
+        for (int i = 0; i < BLOCK_N; i++) {
+            if (live[i] == NULL) {
+                live[i] = arl_bitmap_alloc(&pool);
+                memset(live[i], i, BLOCK_SIZE);
+            }
+        }
+        end = arl_now_ns();
+        total += end - start;
+    }
+
+    free(live);
+    arl_free(&armel);
+    return total / ((uint64_t)BLOCK_ROUNDS * BLOCK_BATCH);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK I/O BUFFER CHURN (4 KB - 4 MB power-of-two buffers)
+////////////////////////////////////////////////////////////////////////////////
+
+#define BUFFER_LIVE 16
+#define BUFFER_OPS 4096
+
+static size_t buffer_size(uint64_t* state) {
+    return (4 * ARL_KB) << (entity_random(state) % 11);
+}
+
+static void buffer_touch(char* buffer, size_t size) {
+    for (size_t i = 0; i < size; i += 4 * ARL_KB) buffer[i] = (char)i;
+}
+
+uint64_t bench_malloc_buffers() {
+    char* live[BUFFER_LIVE] = {0};
+    size_t sizes[BUFFER_LIVE] = {0};
+    uint64_t state = 42;
+
+    uint64_t start = arl_now_ns();
+    for (int i = 0; i < BUFFER_OPS; i++) {
+        size_t at = entity_random(&state) % BUFFER_LIVE;
+        free(live[at]);
+        sizes[at] = buffer_size(&state);
+        live[at] = malloc(sizes[at]);
+        buffer_touch(live[at], sizes[at]);
+    }
+    uint64_t end = arl_now_ns();
+
+    for (int i = 0; i < BUFFER_LIVE; i++) free(live[i]);
+    return (end - start) / BUFFER_OPS;
+}
+
+uint64_t bench_buddy_buffers() {
+    ArlBuddy buddy;
+    arl_buddy_new_mapped(&buddy, 128 * ARL_MB);
+
+    char* live[BUFFER_LIVE] = {0};
+    size_t sizes[BUFFER_LIVE] = {0};
+    uint64_t state = 42;
+
+    uint64_t start = arl_now_ns();
+    for (int i = 0; i < BUFFER_OPS; i++) {
+        size_t at = entity_random(&state) % BUFFER_LIVE;
+        if (live[at]) arl_buddy_free(&buddy, live[at], sizes[at]);
+        sizes[at] = buffer_size(&state);
+        live[at] = arl_buddy_alloc(&buddy, sizes[at]);
+        buffer_touch(live[at], sizes[at]);
+    }
+    uint64_t end = arl_now_ns();
+
+    arl_buddy_destroy(&buddy);
+    return (end - start) / BUFFER_OPS;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK FILE INGESTION (load a 32 MB file, count its lines)
+////////////////////////////////////////////////////////////////////////////////
+
+#define INGEST_PATH "armel_bench_ingest.txt"
+#define INGEST_SIZE (32 * ARL_MB)
+
+static void ingest_prepare() {
+    static int ready = 0;
+    if (ready) return;
+
+    FILE* file = fopen(INGEST_PATH, "wb");
+    for (size_t written = 0; written < INGEST_SIZE; written += 64) {
+        fputs("2024-01-01T00:00:00Z,sensor-0042,temperature,21.5,ok,........\n", file);
+    }
+    fclose(file);
+    ready = 1;
+}
+
+static size_t ingest_count(const char* data, size_t len) {
+    ArlSlice rest = { data, len }, line;
+    size_t lines = 0;
+    while (arl_next_line(&rest, &line)) lines++;
+    return lines;
+}
+
+uint64_t bench_malloc_ingest() {
+    ingest_prepare();
+    uint64_t start = arl_now_ns();
+
+    FILE* file = fopen(INGEST_PATH, "rb");
+    fseek(file, 0, SEEK_END);
+    size_t len = (size_t)ftell(file);
+    rewind(file);
+    char* data = malloc(len);
+    len = fread(data, 1, len, file);
+    fclose(file);
+    volatile size_t lines = ingest_count(data, len);
+    free(data);
+
+    uint64_t end = arl_now_ns();
+    (void)lines;
+    return end - start;
+}
+
+static uint64_t arl_ingest(ArlFileMode mode) {
+    static Armel armel;
+    if (armel.base == NULL) arl_new(&armel, INGEST_SIZE + 2 * ARL_MB);
+    ingest_prepare();
+    uint64_t start = arl_now_ns();
+
+    size_t len;
+    const char* data = arl_read_file_mode(&armel, INGEST_PATH, &len, mode);
+    volatile size_t lines = ingest_count(data, len);
+    arl_reset(&armel);
+
+    uint64_t end = arl_now_ns();
+    (void)lines;
+    return end - start;
+}
+
+uint64_t bench_arl_ingest_read() { return arl_ingest(ARL_FILE_READ); }
+uint64_t bench_arl_ingest_map() { return arl_ingest(ARL_FILE_MAP); }
+uint64_t bench_arl_ingest_direct() { return arl_ingest(ARL_FILE_DIRECT); }
+
+////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK RESPONSE OUTPUT (1 MB in 16 arena chunks, through a pipe)
+////////////////////////////////////////////////////////////////////////////////
+
+#define OUTPUT_CHUNK (64 * ARL_KB)
+#define OUTPUT_CHUNKS 16
+#define OUTPUT_RESPONSES 256
+
+typedef enum { OUTPUT_COPY, OUTPUT_WRITEV, OUTPUT_SPLICE } OutputMode;
+
+static void* output_drain(void* arg) {
+    int fd = *(int*)arg;
+    static char sink[OUTPUT_CHUNK];
+    size_t left = (size_t)OUTPUT_RESPONSES * OUTPUT_CHUNKS * OUTPUT_CHUNK;
+    while (left > 0) {
+        ssize_t got = read(fd, sink, sizeof(sink));
+        if (got <= 0) break;
+        left -= (size_t)got;
+    }
+    return NULL;
+}
+
+static uint64_t output_run(OutputMode mode) {
+    Armel armel;
+    ArlOutput out;
+    pthread_t consumer;
+    int fds[2];
+
+    arl_new(&armel, 2 * OUTPUT_CHUNKS * OUTPUT_CHUNK);
+    char* staging = malloc(OUTPUT_CHUNKS * OUTPUT_CHUNK);
+    if (pipe(fds) != 0) return 0;
+    pthread_create(&consumer, NULL, output_drain, &fds[0]);
+
+    uint64_t start = arl_now_ns();
+    for (int r = 0; r < OUTPUT_RESPONSES; r++) {
+        arl_output_init(&out);
+        for (int c = 0; c < OUTPUT_CHUNKS; c++) {
+            char* chunk = arl_alloc(&armel, OUTPUT_CHUNK);
+            chunk[0] = (char)c;   // the body is built in place
+            arl_output_add(&out, chunk, OUTPUT_CHUNK);
+        }
+
+        if (mode == OUTPUT_COPY) {
+            size_t len = 0;
+            for (int i = 0; i < out.count; i++) {
+                memcpy(staging + len, out.iov[i].iov_base, out.iov[i].iov_len);
+                len += out.iov[i].iov_len;
+            }
+            for (size_t done = 0; done < len; ) {
+                ssize_t n = write(fds[1], staging + done, len - done);
+                if (n <= 0) break;
+                done += (size_t)n;
+            }
+        } else if (mode == OUTPUT_WRITEV) {
+            arl_output_write(&out, fds[1]);
+        } else {
+            arl_output_splice(&out, &armel, fds[1]);
+            while (!arl_output_drained(&out)) sched_yield();
+        }
+
+        arl_reset(&armel);
+    }
+    pthread_join(consumer, NULL);
+    uint64_t end = arl_now_ns();
+
+    close(fds[0]);
+    close(fds[1]);
+    free(staging);
+    arl_free(&armel);
+    return (end - start) / OUTPUT_RESPONSES;
+}
+
+uint64_t bench_output_copy() { return output_run(OUTPUT_COPY); }
+uint64_t bench_output_writev() { return output_run(OUTPUT_WRITEV); }
+
+#if defined(__linux__)
+uint64_t bench_output_splice() { return output_run(OUTPUT_SPLICE); }
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK ARENA STARTUP (create a 1 GB ARL_ZEROS arena, ns per arena)
+////////////////////////////////////////////////////////////////////////////////
+
+#define STARTUP_SIZE ARL_GB
+
+uint64_t bench_startup_memset() {
+    uint64_t start = arl_now_ns();
+    Armel arena;
+    arl_new_custom(&arena, STARTUP_SIZE, 64, ARL_ZEROS);
+    uint64_t end = arl_now_ns();
+
+    arl_free(&arena);
+    return end - start;
+}
+
+static uint64_t startup_prefault(int threads) {
+    uint64_t start = arl_now_ns();
+    Armel arena;
+    arl_new_prefault(&arena, STARTUP_SIZE, 64, ARL_ZEROS, threads, ARL_NUMA_ANY);
+    uint64_t end = arl_now_ns();
+
+    arl_free(&arena);
+    return end - start;
+}
+
+uint64_t bench_startup_prefault_1() { return startup_prefault(1); }
+uint64_t bench_startup_prefault_2() { return startup_prefault(2); }
+uint64_t bench_startup_prefault_4() { return startup_prefault(4); }
+uint64_t bench_startup_prefault_8() { return startup_prefault(8); }
+uint64_t bench_startup_prefault_all() { return startup_prefault(0); }
+
 int main() {
     printf("=== Benchmark (N = %d) ===\n", N);
 
@@ -187,5 +1144,88 @@ int main() {
     arl_bench_avg("arl_array", bench_arl_array);
     sleep(1);
 
+    arl_bench_avg("malloc + SPSC queue", bench_malloc_queue);
+    sleep(1);
+    arl_bench_avg("arl_ring (SPSC)", bench_arl_ring);
+    sleep(1);
+
+    arl_bench_avg("byte ring (split copies)", bench_split_ring);
+    sleep(1);
+    arl_bench_avg("arl_mirror (contiguous)", bench_arl_mirror);
+    sleep(1);
+
+    for (mpsc_producers = 1; mpsc_producers <= 32; mpsc_producers *= 2) {
+        char label[64];
+        snprintf(label, sizeof(label), "malloc MPSC queue (%d producers)", mpsc_producers);
+        arl_bench_avg(label, bench_malloc_mpsc);
+        sleep(1);
+        snprintf(label, sizeof(label), "arl_mpsc (%d producers)", mpsc_producers);
+        arl_bench_avg(label, bench_arl_mpsc);
+        sleep(1);
+    }
+
+    arl_bench_avg("malloc/free across threads", bench_malloc_churn);
+    sleep(1);
+    arl_bench_avg("pool + mutex across threads", bench_locked_pool_churn);
+    sleep(1);
+    arl_bench_avg("arl_pool remote free", bench_arl_pool_churn);
+    sleep(1);
+
+    arl_bench_avg("tree lookups (pointers, 24 B nodes)", bench_ptr_tree);
+    sleep(1);
+    arl_bench_avg("tree lookups (arl_ref32, 12 B nodes)", bench_ref_tree);
+    sleep(1);
+
+    arl_bench_avg("entity churn (arl_pool + pointers)", bench_pool_entity_churn);
+    sleep(1);
+    arl_bench_avg("entity churn (arl_handle_pool)", bench_handle_entity_churn);
+    sleep(1);
+    arl_bench_avg("entity iteration, ps/object (arl_pool + pointers)", bench_pool_entity_iterate);
+    sleep(1);
+    arl_bench_avg("entity iteration, ps/object (arl_handle_pool)", bench_handle_entity_iterate);
+    sleep(1);
+
+    arl_bench_avg("random frees + refill (arl_pool free list)", bench_pool_random_free);
+    sleep(1);
+    arl_bench_avg("random frees + refill (arl_bitmap)", bench_bitmap_random_free);
+    sleep(1);
+
+    arl_bench_avg("I/O buffer churn (malloc)", bench_malloc_buffers);
+    sleep(1);
+    arl_bench_avg("I/O buffer churn (arl_buddy)", bench_buddy_buffers);
+    sleep(1);
+
+    arl_bench_avg("32 MB file: fread into malloc", bench_malloc_ingest);
+    sleep(1);
+    arl_bench_avg("32 MB file: arl_read_file (read)", bench_arl_ingest_read);
+    sleep(1);
+    arl_bench_avg("32 MB file: arl_read_file (map)", bench_arl_ingest_map);
+    sleep(1);
+    arl_bench_avg("32 MB file: arl_read_file (O_DIRECT)", bench_arl_ingest_direct);
+    sleep(1);
+    remove(INGEST_PATH);
+
+    arl_bench_avg("1 MB response: copy + write", bench_output_copy);
+    sleep(1);
+    arl_bench_avg("1 MB response: arl_output_write (writev)", bench_output_writev);
+    sleep(1);
+#if defined(__linux__)
+    arl_bench_avg("1 MB response: arl_output_splice (vmsplice)", bench_output_splice);
+    sleep(1);
+#endif
+
+    arl_bench_avg("1 GB ARL_ZEROS arena: arl_new_custom (memset)", bench_startup_memset);
+    sleep(1);
+    arl_bench_avg("1 GB ARL_ZEROS arena: arl_new_prefault, 1 thread", bench_startup_prefault_1);
+    sleep(1);
+    arl_bench_avg("1 GB ARL_ZEROS arena: arl_new_prefault, 2 threads", bench_startup_prefault_2);
+    sleep(1);
+    arl_bench_avg("1 GB ARL_ZEROS arena: arl_new_prefault, 4 threads", bench_startup_prefault_4);
+    sleep(1);
+    arl_bench_avg("1 GB ARL_ZEROS arena: arl_new_prefault, 8 threads", bench_startup_prefault_8);
+    sleep(1);
+    arl_bench_avg("1 GB ARL_ZEROS arena: arl_new_prefault, one per CPU", bench_startup_prefault_all);
+    sleep(1);
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,174 @@
+// C++ benchmarks for armel.hpp.
+//
+// Build (the C sources are compiled as C, then linked):
+//   gcc -std=c11 -O2 -Iincludes -c src/armel.c src/armel_sys.c
+//   g++ -std=c++20 -O2 -Iincludes bench_pmr.cpp armel.o armel_sys.o -o bench_pmr
+//
+// The coroutine benchmarks need -std=c++20; they are skipped with -std=c++17.
+
+#include <exception>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <Armel/armel.hpp>
+#include <Armel/armel_bench.h>
+
+#define REQUESTS 100000
+#define ITEMS 64
+
+////////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK PER-REQUEST CONTAINERS (VECTOR + STRINGS + MAP, THEN DROP EVERYTHING)
+
+static void fill_request(std::pmr::memory_resource* resource, volatile size_t* sink) {
+    std::pmr::vector<int> values(resource);
+    std::pmr::vector<std::pmr::string> names(resource);
+
+    for (int i = 0; i < ITEMS; i++) {
+        values.push_back(i);
+        names.emplace_back("header-name-that-does-not-fit-in-sso");
+    }
+    *sink = *sink + values.size() + names.back().size();
+}
+
+uint64_t bench_new_delete_resource() {
+    volatile size_t sink = 0;
+
+    uint64_t start = arl_now_ns();
+    for (int r = 0; r < REQUESTS; r++) {
+        fill_request(std::pmr::new_delete_resource(), &sink);
+    }
+    uint64_t end = arl_now_ns();
+    return (end - start) / REQUESTS;
+}
+
+uint64_t bench_monotonic_resource() {
+    static unsigned char buffer[256 * 1024];
+    volatile size_t sink = 0;
+
+    uint64_t start = arl_now_ns();
+    for (int r = 0; r < REQUESTS; r++) {
+        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer));
+        fill_request(&resource, &sink);
+    }
+    uint64_t end = arl_now_ns();
+    return (end - start) / REQUESTS;
+}
+
+uint64_t bench_armel_resource() {
+    armel::Arena arena(256 * ARL_KB);
+    armel::Resource resource(arena);
+    volatile size_t sink = 0;
+
+    uint64_t start = arl_now_ns();
+    for (int r = 0; r < REQUESTS; r++) {
+        armel::Scope scope(arena);
+        fill_request(&resource, &sink);
+    }
+    uint64_t end = arl_now_ns();
+    return (end - start) / REQUESTS;
+}
+
+#if defined(__cpp_impl_coroutine)
+
+////////////////////////////////////////////////////////////////////////////////////
+///// BENCHMARK COROUTINE FRAMES (DEEP CHAIN OF SHORT-LIVED AWAITED CALLS)
+
+#define CHAINS 20000
+#define CHAIN_DEPTH 64
+
+struct HeapFrames {};
+
+template <class Frames>
+struct Task {
+    struct promise_type : Frames {
+        int value = 0;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        void return_value(int v) { value = v; }
+        void unhandled_exception() { std::terminate(); }
+
+        struct Final {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        Final final_suspend() noexcept { return {}; }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool await_ready() { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) {
+        handle.promise().continuation = c;
+        return handle;
+    }
+    int await_resume() { return handle.promise().value; }
+
+    int run() {
+        handle.resume();
+        return handle.promise().value;
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <class Frames>
+Task<Frames> chain(int depth) {
+    if (depth == 0) co_return 0;
+    co_return 1 + co_await chain<Frames>(depth - 1);
+}
+
+uint64_t bench_heap_coroutines() {
+    volatile int sink = 0;
+
+    uint64_t start = arl_now_ns();
+    for (int i = 0; i < CHAINS; i++) {
+        sink = sink + chain<HeapFrames>(CHAIN_DEPTH).run();
+    }
+    uint64_t end = arl_now_ns();
+    return (end - start) / ((uint64_t)CHAINS * (CHAIN_DEPTH + 1));
+}
+
+uint64_t bench_armel_coroutines() {
+    armel::Arena arena(64 * ARL_KB);
+    armel::FrameScope frames(arena);
+    volatile int sink = 0;
+
+    uint64_t start = arl_now_ns();
+    for (int i = 0; i < CHAINS; i++) {
+        sink = sink + chain<armel::Frames>(CHAIN_DEPTH).run();
+    }
+    uint64_t end = arl_now_ns();
+    return (end - start) / ((uint64_t)CHAINS * (CHAIN_DEPTH + 1));
+}
+
+#endif
+
+int main() {
+    printf("=== C++ Benchmark (requests = %d, items = %d) ===\n", REQUESTS, ITEMS);
+
+    arl_bench_avg("pmr new_delete_resource", bench_new_delete_resource);
+    sleep(1);
+    arl_bench_avg("pmr monotonic_buffer_resource", bench_monotonic_resource);
+    sleep(1);
+    arl_bench_avg("armel::Resource + Scope", bench_armel_resource);
+    sleep(1);
+
+#if defined(__cpp_impl_coroutine)
+    arl_bench_avg("coroutine frames (operator new)", bench_heap_coroutines);
+    sleep(1);
+    arl_bench_avg("coroutine frames (armel::Frames)", bench_armel_coroutines);
+    sleep(1);
+#endif
+
+    return 0;
+}
@@ -41,6 +41,10 @@
 #include <string.h>
 #include <Armel/armel_sys.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * @def ARL_KB
  * @brief Number of bytes in a kilobyte (1 KB = 1024 bytes)
@@ -82,6 +86,42 @@
 	#endif
 #endif
 
+/**
+ * @def ARL_CACHE_LINE
+ * @brief Cache line size used to keep concurrently written fields apart.
+ *
+ * 128 bytes on Apple Silicon (adjacent-line prefetch), 64 bytes otherwise.
+ */
+#ifndef ARL_CACHE_LINE
+	#if defined(__APPLE__) && (defined(__aarch64__) || defined(__arm64__))
+		#define ARL_CACHE_LINE 128
+	#else
+		#define ARL_CACHE_LINE 64
+	#endif
+#endif
+
+/**
+ * @def ARL_CACHE_MAX
+ * @brief Maximum number of released blocks an arena keeps for reuse.
+ *
+ * Blocks chained by arl_overflow_grow() are cached on reset instead of being
+ * returned to the system, up to this count. Define it before including Armel to change it.
+ */
+#ifndef ARL_CACHE_MAX
+	#define ARL_CACHE_MAX 16
+#endif
+
+/**
+ * @def ARL_CACHE_BYTES
+ * @brief Maximum number of bytes an arena keeps in its cache of released blocks.
+ *
+ * A block that would take the cache past this size goes back to the system, so a
+ * few huge blocks (large allocations, deep growth) are not pinned forever.
+ */
+#ifndef ARL_CACHE_BYTES
+	#define ARL_CACHE_BYTES (64 * ARL_MB)
+#endif
+
 /**
  * @def ARL_DEFAULT_ALIGNMENT
  * @brief Internal alias to ARL_ALIGN.
@@ -217,6 +257,68 @@
     #define ARL_ALIGNAS(x) /* fallback: no alignment */
 #endif
     
+typedef struct Armel Armel;
+typedef struct ArlRecord ArlRecord;
+
+/**
+ * @brief Overflow handler called when an allocation does not fit in the arena.
+ *
+ * The handler receives the arena, the requested size and the user context given to
+ * arl_set_overflow_handler(). It returns memory for the request, or NULL to make
+ * arl_alloc() fail. Handlers only run on the outlined slow path: the inline bump
+ * allocation is unchanged.
+ *
+ * Built-in policies: arl_overflow_abort, arl_overflow_null, arl_overflow_grow,
+ * arl_overflow_malloc and arl_overflow_parent.
+ */
+typedef void* (*ArlOverflowFn) (Armel *armel, size_t size, void *ctx);
+
+/**
+ * @brief Callback invoked when a record is unwound by reset, rewind or free.
+ */
+typedef void (*ArlReleaseFn) (Armel *armel, ArlRecord *record);
+
+/**
+ * @brief Finalizer registered with arl_defer().
+ */
+typedef void (*ArlDeferFn) (void *ctx);
+
+/**
+ * @brief Callback receiving the peak usage of an arena on reset and free.
+ *
+ * See arl_set_peak_observer().
+ */
+typedef void (*ArlPeakFn) (Armel *armel, size_t peak, void *ctx);
+
+/**
+ * @struct ArlRecord
+ * @brief Bookkeeping entry for memory or cleanup owned by the arena outside of its bump region.
+ *
+ * Records form a LIFO stack ordered by arena offset. Each one saves the arena state
+ * it replaced, so that arl_rewind_to() and arl_reset() can unwind them in order and
+ * call their release function. Chained blocks, out-of-line allocations and other
+ * extensions all go through this single mechanism.
+ *
+ * Fields:
+ *   - prev:    Previous record on the stack
+ *   - release: Called when the record is unwound
+ *   - mark:    Arena offset when the record was pushed (rewinding to it unwinds the record)
+ *   - base, end, offset, floor: Arena state saved at push time
+ *   - size:    Size of the out-of-line memory owned by the record (if any)
+ *
+ * Records are internal: use them only to extend Armel itself.
+ */
+struct ArlRecord {
+	ArlRecord *prev;
+	ArlReleaseFn release;
+	uintptr_t mark;
+	void *base;
+	void *end;
+	uintptr_t offset;
+	uintptr_t floor;
+	size_t size;
+};
+
 /**
  * @struct Armel
  * @brief A linear (bump) memory allocator.
@@ -226,22 +328,46 @@
  * arl_alloc() and related macros. Memory is released in bulk via reset or free.
  *
  * Fields:
- *   - base:    Start of the allocated memory buffer (read-only)
+ *   - base:    Start of the current memory block (read-only)
  *   - cursor:  Current allocation pointer (moves forward)
- *   - end:     End of the buffer (used for overflow checks)
+ *   - end:     End of the current block (used for overflow checks)
  *   - alignment: Alignment in bytes (power of 2, typically 8 or 16)
  *   - flags:   Configuration flags (ARL_ZEROS, SOFTFAIL, etc.)
+ *   - offset:  Arena offset of base (non-zero once blocks have been chained)
+ *   - floor:   Lowest offset arl_rewind_to() can reach without unwinding records
+ *   - records: Stack of chained blocks and out-of-line memory (see ArlRecord)
+ *   - spare:   Cache of released blocks, reused before asking the system
+ *   - overflow, overflow_ctx: Overflow policy (see arl_set_overflow_handler)
+ *   - large:   Requests above this size get a dedicated block (see arl_set_large_threshold)
+ *   - inbox:   Blocks handed back by other threads, moved to the cache by the owner
+ *   - peak, observer, observer_ctx: High-water mark tracking (see arl_set_peak_observer)
+ *   - tag:     Budget tag charged for the arena's blocks (see arl_budget_use)
+ *   - root, root_end: First block, which compressed references are relative to (see armel_ref.h)
  *
  * Do not modify fields manually unless you know what you're doing.
  */
-typedef struct {
+struct Armel {
     void* base;
     void* cursor;
     void* end;
 	size_t alignment;
     size_t mask;
 	uint8_t flags;
-} Armel;
+	uintptr_t offset;
+	uintptr_t floor;
+	ArlRecord *records;
+	ArlRecord *spare;
+	ArlOverflowFn overflow;
+	void *overflow_ctx;
+	size_t large;
+	ArlRecord *inbox;
+	uintptr_t peak;
+	ArlPeakFn observer;
+	void *observer_ctx;
+	int tag;
+	void *root;
+	void *root_end;
+};
 
 /**
  * @brief Initializes an arena using a user-provided memory buffer.
@@ -272,12 +398,16 @@ static inline void arl_new_local (Armel *armel, void *buffer, size_t size, size_
 		ARL_FATAL("arl_new_local: alignment must be a non-zero power of 2");
 	}
 
+	memset(armel, 0, sizeof(*armel));
 	armel->base = buffer;
 	armel->cursor = buffer;
 	armel->end = (uint8_t*)buffer + size;
+	armel->root = armel->base;
+	armel->root_end = armel->end;
 	armel->alignment = alignment;
     armel->mask = alignment - 1;
 	armel->flags = flags;
+	armel->large = SIZE_MAX;
 }
 
 /**
@@ -319,6 +449,9 @@ static inline size_t arl_align_up(size_t size, size_t align) {
  * @param armel Pointer to an arena to initialise
  * @param size Capacity of the Arena in bytes
  * @param alignment The alignment to be applied, must be a power of 2
+ *
+ * @note If the memory budget refuses the mapping (see arl_budget_set), the arena is
+ *       left empty with ARL_SOFTFAIL (every allocation returns NULL), otherwise this aborts.
  */
 void arl_new_custom (Armel* armel, size_t size, size_t alignment, uint8_t flags);
 
@@ -328,15 +461,7 @@ void arl_new_custom (Armel* armel, size_t size, size_t alignment, uint8_t flags)
  * @param size Capacity of the Arena in bytes
  */
 static inline void arl_new (Armel* armel, size_t size) {
-	size_t padded_size = arl_align_up(size, ARL_ALIGN);
-    void* ptr = arl_sys_alloc(padded_size);
-
-    armel->base = ptr;
-    armel->cursor = ptr;
-    armel->end = (char*)ptr + padded_size;
-	armel->alignment = ARL_ALIGN;
-	armel->mask = ARL_ALIGN - 1;
-	armel->flags = ARL_NOFLAG;
+	arl_new_custom(armel, size, ARL_ALIGN, ARL_NOFLAG);
 }
 
 /**
@@ -356,6 +481,34 @@ static inline void arl_new (Armel* armel, size_t size) {
  */
 void arl_free (Armel *armel);
 
+/**
+ * @brief Returns the arena's cached blocks to the system.
+ *
+ * Blocks released by reset, rewind or other threads are kept for reuse: trimming
+ * gives that memory back, typically when the memory budget's soft limit is crossed.
+ *
+ * @param armel Pointer to the arena (owner thread)
+ */
+void arl_trim (Armel *armel);
+
+/**
+ * @brief Unwinds the records above an offset, then moves the cursor there.
+ *
+ * Slow path shared by arl_rewind_to() and arl_reset(): it pops chained blocks and
+ * out-of-line allocations in LIFO order, calling their release function.
+ *
+ * @param armel  Pointer to the arena
+ * @param offset Target offset (as returned by arl_offset())
+ */
+void arl_unwind (Armel *armel, uintptr_t offset);
+
+/**
+ * @brief Reports the arena's high-water mark to its peak observer and clears it.
+ *
+ * Called by arl_reset() and arl_free() when an observer is set.
+ */
+void arl_observe_peak (Armel *armel);
+
 /**
  * @brief Resets the arena by moving the cursor back to the beginning.
  *
@@ -363,7 +516,8 @@ void arl_free (Armel *armel);
  * without releasing the underlying memory buffer.
  * Use it to reuse the arena for new allocations without any overhead.
  *
- * This is a constant-time operation.
+ * This is a constant-time operation, unless the arena grew through an overflow
+ * policy: chained blocks are then returned to the arena's cache.
  *
  * @param armel Pointer to the arena to reset
  *
@@ -371,9 +525,29 @@ void arl_free (Armel *armel);
  *     arl_reset(&armel);
  */
 static inline void arl_reset (Armel *armel) {
+	if (armel->observer != NULL) {
+		arl_observe_peak(armel);
+	}
+	if (armel->records != NULL) {
+		arl_unwind(armel, 0);
+		return;
+	}
     armel->cursor = armel->base;
 }
 
+/**
+ * @brief Outlined slow path of arl_alloc(), taken when the request does not fit
+ * or is above the large-allocation threshold.
+ *
+ * Large requests get a dedicated block. Otherwise, dispatches to the overflow handler
+ * if one is set, returns NULL with ARL_SOFTFAIL, or prints the arena state and aborts.
+ *
+ * @param armel The arena where the request failed
+ * @param size  Size in bytes of the request
+ * @return A pointer to the allocated memory, or NULL
+ */
+void* arl_alloc_slow (Armel *armel, size_t size);
+
 /**
  * @brief Request an allocation of size bytes in the arena armel, 
  * with a align bytes alignment. The flags allows the caller to 
@@ -394,18 +568,9 @@ static inline void* arl_alloc (Armel *armel, size_t size) {
 	const uintptr_t end = (uintptr_t)armel->end;
 	void* ptr = (void*)start;
 
-	if (stop > end) {
-		if (armel->flags & ARL_SOFTFAIL) {
-			return NULL;
-		}
-
-		fprintf(stderr, "Armel arena error: out of memory.\n"
-        				"  Requested : %zu bytes\n"
-        				"  Remaining : %zu bytes\n"
-        				"  Cursor    : %p\n"
-        				"  End       : %p\n",
-        			size, (uintptr_t)armel->end - start, armel->cursor, armel->end);
-		abort();
+	// stop < start: a size near SIZE_MAX wrapped around the address space
+	if (stop > end || stop < start || size > armel->large) {
+		return arl_alloc_slow(armel, size);
 	}
 
 	if (armel->flags & ARL_ZEROS) {
@@ -447,46 +612,58 @@ static inline void* arl_alloc_zeroed (Armel *armel, size_t size) {
  * Use this function to mark a point in the arena's memory, allowing you to rewind to it later
  * using arl_rewind_to(). This is useful for temporary allocations or controlled rollback.
  *
+ * Once the arena has chained blocks or out-of-line allocations, the offset keeps
+ * growing across them: it is the total number of bytes handed out since the last reset.
+ *
  * @param armel Pointer to the arena.
- * @return Offset (in bytes) from armel->base to armel->cursor.
+ * @return Offset (in bytes) from the start of the arena to armel->cursor.
  *
  * @note This is especially useful for temporary memory scopes, simulated sub-arenas,
  *       or canceling allocations without resetting the entire arena.
  */
 static inline uintptr_t arl_offset (Armel *armel) {
-	return (uintptr_t)armel->cursor - (uintptr_t)armel->base;
+	return armel->offset + ((uintptr_t)armel->cursor - (uintptr_t)armel->base);
 }
 
 /**
  * @brief Rewinds the arena cursor to a previously saved offset.
  *
  * This effectively "frees" all allocations made after the given offset.
- * Typically used in conjunction with arl_offset().
+ * Typically used in conjunction with arl_offset(). Chained blocks and out-of-line
+ * allocations made after the offset are released as well.
  *
  * @param armel  Pointer to the arena.
- * @param offset Offset (in bytes) from armel->base.
+ * @param offset Offset (in bytes) as returned by arl_offset().
  *
  * @note The offset must not exceed the arena's total size.
  *       If the offset is invalid, this will trigger ARL_CHECK().
  */
 static inline void arl_rewind_to (Armel *armel, uintptr_t offset) {
+	if (armel->observer != NULL && arl_offset(armel) > armel->peak) {
+		armel->peak = arl_offset(armel);
+	}
+	if (offset < armel->floor) {
+		arl_unwind(armel, offset);
+		return;
+	}
+
 	uintptr_t limit = (uintptr_t)armel->end - (uintptr_t)armel->base;
-    ARL_CHECK(offset <= limit, "arl_rewind_to : offset out of bounds");
+    ARL_CHECK(offset - armel->offset <= limit, "arl_rewind_to : offset out of bounds");
 
-	armel->cursor = (uint8_t*)armel->base + offset;
+	armel->cursor = (uint8_t*)armel->base + (offset - armel->offset);
 }
 
 /**
  * @brief Returns the number of bytes currently used in the arena.
  *
- * This includes any internal padding due to alignment. Useful for
- * tracking memory usage or debugging.
+ * This includes any internal padding due to alignment, chained blocks and
+ * out-of-line allocations. Useful for tracking memory usage or debugging.
  *
  * @param armel Pointer to the arena
  * @return Number of bytes allocated so far
  */
 static inline size_t arl_used (Armel *armel) {
-	return (uintptr_t)armel->cursor - (uintptr_t)armel->base;
+	return arl_offset(armel);
 }
 
 /**
@@ -502,6 +679,201 @@ static inline size_t arl_remaining (Armel *armel) {
 	return (uintptr_t)armel->end - arl_align_up((uintptr_t)armel->cursor, armel->alignment);
 }
 
+/**
+ * @brief Installs an overflow policy on the arena.
+ *
+ * The handler is called from the slow path of arl_alloc() whenever a request does
+ * not fit in the current block. Pass NULL to restore the default behavior
+ * (NULL with ARL_SOFTFAIL, abort otherwise).
+ *
+ * @param armel Pointer to the arena
+ * @param fn    Overflow handler (built-in policy or user callback), or NULL
+ * @param ctx   User context passed to the handler
+ *
+ * Example:
+ *     arl_set_overflow_handler(&armel, arl_overflow_grow, NULL);
+ *     arl_set_overflow_handler(&child, arl_overflow_parent, &parent);
+ */
+static inline void arl_set_overflow_handler (Armel *armel, ArlOverflowFn fn, void *ctx) {
+	armel->overflow = fn;
+	armel->overflow_ctx = ctx;
+}
+
+/**
+ * @brief Serves allocations above a threshold from dedicated blocks linked into the arena.
+ *
+ * Requests strictly larger than `threshold` bytes bypass the bump region: they get their
+ * own system mapping (or a block from the arena's cache), so a few huge buffers do not
+ * force every arena to be sized for the worst case. These blocks are returned to the
+ * cache or released on arl_reset(), arl_rewind_to() and arl_free().
+ *
+ * @param armel     Pointer to the arena
+ * @param threshold Size in bytes above which requests bypass the arena (0 disables it)
+ *
+ * Example:
+ *     arl_set_large_threshold(&armel, 256 * ARL_KB);
+ */
+static inline void arl_set_large_threshold (Armel *armel, size_t threshold) {
+	armel->large = threshold ? threshold : SIZE_MAX;
+}
+
+/**
+ * @brief Sets a callback receiving the arena's peak usage on every reset and free.
+ *
+ * The high-water mark is the largest arl_offset() reached since the last report,
+ * chained and out-of-line memory included. It is sampled on rewinds, resets and
+ * free only: allocations stay untouched, and arenas without an observer pay nothing.
+ *
+ * @param armel Pointer to the arena
+ * @param fn    Callback (NULL to stop observing)
+ * @param ctx   Context passed to the callback
+ */
+static inline void arl_set_peak_observer (Armel *armel, ArlPeakFn fn, void *ctx) {
+	armel->observer = fn;
+	armel->observer_ctx = ctx;
+	armel->peak = arl_offset(armel);
+}
+
+/**
+ * @brief Overflow policy: print the arena state and abort (default without ARL_SOFTFAIL).
+ */
+void* arl_overflow_abort (Armel *armel, size_t size, void *ctx);
+
+/**
+ * @brief Overflow policy: return NULL (default with ARL_SOFTFAIL).
+ */
+void* arl_overflow_null (Armel *armel, size_t size, void *ctx);
+
+/**
+ * @brief Overflow policy: chain a new system block and keep allocating from it.
+ *
+ * Each new block is at least twice as large as the current one. Blocks are returned
+ * to the arena's cache on reset or rewind, and released by arl_free().
+ * The context is unused.
+ */
+void* arl_overflow_grow (Armel *armel, size_t size, void *ctx);
+
+/**
+ * @brief Overflow policy: fall back to malloc(), tracked by the arena.
+ *
+ * The block is freed automatically when the arena is reset, rewound before it,
+ * or freed. The context is unused.
+ */
+void* arl_overflow_malloc (Armel *armel, size_t size, void *ctx);
+
+/**
+ * @brief Overflow policy: spill the request to a parent arena.
+ *
+ * The context must be a pointer to the parent Armel. The memory belongs to the
+ * parent and lives until the parent itself is reset, rewound or freed.
+ */
+void* arl_overflow_parent (Armel *armel, size_t size, void *ctx);
+
+/**
+ * @brief Pushes a record on the arena's record stack.
+ *
+ * Saves the current arena state in the record, accounts for `extent` out-of-line
+ * bytes in the arena offset, and raises the rewind floor so that any rewind before
+ * this point unwinds the record. Intended for extensions of the allocator.
+ *
+ * @param armel   Pointer to the arena
+ * @param record  Record to push (must stay valid until released)
+ * @param release Function called when the record is unwound
+ * @param extent  Number of out-of-line bytes owned by the record
+ */
+void arl_record_push (Armel *armel, ArlRecord *record, ArlReleaseFn release, size_t extent);
+
+/**
+ * @brief Registers a finalizer that runs when the arena releases this point.
+ *
+ * The cleanup record is stored in the arena itself. Finalizers run in LIFO order
+ * when the arena is reset, freed, or rewound to an offset taken before this call.
+ * Arenas without finalizers pay nothing, and a rewind only visits the records
+ * above its target.
+ *
+ * @param armel Pointer to the arena
+ * @param fn    Function to call (must not allocate from or rewind this arena)
+ * @param ctx   Argument passed to `fn`
+ * @return 1 on success, 0 if the record could not be allocated (with ARL_SOFTFAIL)
+ *
+ * Example:
+ * ```c
+ * static void close_file (void *f) { fclose(f); }
+ *
+ * FILE* f = fopen(path, "rb");
+ * arl_defer(&arena, close_file, f);
+ * ...
+ * arl_reset(&arena); // closes the file
+ * ```
+ */
+int arl_defer (Armel *armel, ArlDeferFn fn, void *ctx);
+
+/**
+ * @struct ArlDetached
+ * @brief Blocks moved out of an arena by arl_detach(), owned by whoever holds the handle.
+ *
+ * Fields:
+ *   - records: Detached blocks (chained blocks and out-of-line allocations)
+ *   - origin:  Arena the blocks came from, whose cache gets them back
+ *   - size:    Number of bytes allocated in the blocks
+ */
+typedef struct {
+	ArlRecord *records;
+	Armel *origin;
+	size_t size;
+} ArlDetached;
+
+/**
+ * @brief Starts a fresh block and returns its offset, for a later arl_detach().
+ *
+ * Everything allocated after this call can be detached. Without it, allocations
+ * that still fit in the current block would stay behind.
+ *
+ * @param armel Pointer to the arena
+ * @return Offset to pass to arl_detach()
+ */
+uintptr_t arl_detach_mark (Armel *armel);
+
+/**
+ * @brief Moves the blocks allocated since `mark` out of the arena, without copying.
+ *
+ * The arena rewinds to `mark` but the memory stays valid: it now belongs to the
+ * returned handle, which can be given to another thread. The arena should chain
+ * blocks (see arl_overflow_grow) for data bigger than one block.
+ *
+ * @param armel Pointer to the arena
+ * @param mark  Offset returned by arl_detach_mark()
+ * @return Handle owning the detached blocks
+ *
+ * @note `mark` must be at the start of a block: if data was allocated between `mark`
+ *       and the first detachable block, this triggers ARL_CHECK().
+ * @note The origin arena must outlive the handle.
+ */
+ArlDetached arl_detach (Armel *armel, uintptr_t mark);
+
+/**
+ * @brief Gives ownership of detached blocks to another arena.
+ *
+ * The blocks are released (see arl_release) when `armel` is reset, freed, or
+ * rewound before this call.
+ *
+ * @param armel  Arena taking ownership (typically owned by the consuming thread)
+ * @param handle Handle returned by arl_detach(); emptied by this call
+ */
+void arl_attach (Armel *armel, ArlDetached *handle);
+
+/**
+ * @brief Returns detached blocks to their origin arena's cache.
+ *
+ * Finalizers registered in the blocks (see arl_defer) run first, in reverse
+ * order like arl_reset(). Then, safe from any thread, blocks are pushed to the
+ * origin's inbox with a lock-free exchange and moved to its cache the next time
+ * it needs a block.
+ *
+ * @param handle Handle returned by arl_detach(); emptied by this call
+ */
+void arl_release (ArlDetached *handle);
+
 /**
  * @brief Prints the internal state of the arena to stdout.
  *
@@ -512,4 +884,8 @@ static inline size_t arl_remaining (Armel *armel) {
  */
 void arl_print_info (Armel *armel);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,354 @@
+/**
+ * @file armel.hpp
+ * @brief C++17 adapters over Armel arenas: std::pmr resource, STL allocator, RAII guards.
+ *
+ * Header-only layer on top of armel.h, for C++ code that wants arena memory in
+ * standard containers without wrapping every call:
+ *   - armel::Resource:     std::pmr::memory_resource over an Armel
+ *   - armel::Allocator<T>: classic STL allocator over an Armel
+ *   - armel::Arena:        owns an Armel, freed by its destructor
+ *   - armel::Scope:        rewinds an Armel to where it was when the scope opened
+ *   - armel::make<T>():    allocates and constructs a T in an Armel
+ *   - armel::Frames:       C++20 promise mixin allocating coroutine frames in an Armel
+ *
+ * Everything but Frames builds as C++17. Frames (with FrameScope) is only compiled
+ * when the compiler implements coroutines (`__cpp_impl_coroutine`, C++20 mode).
+ *
+ * Deallocation is a no-op, except for the most recent allocation, which is given
+ * back to the arena (LIFO pop). This is what a growing vector needs.
+ *
+ * Objects created with armel::make<T>() are destroyed when the arena is reset,
+ * rewound before them or freed (see arl_defer). Container memory is just released.
+ *
+ * Example:
+ * ```cpp
+ * armel::Arena arena(ARL_MB);
+ * armel::Resource resource(arena);
+ *
+ * {
+ *     armel::Scope scope(arena);
+ *     std::pmr::vector<int> values(&resource);
+ *     std::pmr::string name("request", &resource);
+ *     Point* p = armel::make<Point>(arena, 1, 2);
+ * } // everything allocated in the scope is released here
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_HPP
+#define ARMEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine)
+	#include <coroutine>
+#endif
+
+#include <Armel/armel.h>
+
+namespace armel {
+
+/**
+ * @brief Allocates `bytes` aligned to `align` from the arena.
+ *
+ * Alignments above the arena's own are served by over-allocating.
+ *
+ * @throws std::bad_alloc if the arena returns NULL (ARL_SOFTFAIL or a null overflow policy)
+ */
+inline void* allocate (Armel *armel, std::size_t bytes, std::size_t align) {
+	void *ptr;
+
+	if (align <= armel->alignment) {
+		ptr = arl_alloc(armel, bytes);
+	} else {
+		std::size_t padded = bytes + align - armel->alignment;
+		unsigned char *raw = static_cast<unsigned char*>(arl_alloc(armel, padded));
+
+		ptr = raw;
+		if (raw != nullptr) {
+			ptr = reinterpret_cast<void*>(arl_align_up(reinterpret_cast<uintptr_t>(raw), align));
+
+			// Give back the unused tail, so that pop() still works on this block
+			if (armel->cursor == raw + padded) {
+				armel->cursor = static_cast<unsigned char*>(ptr) + bytes;
+			}
+		}
+	}
+
+	if (ptr == nullptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+/**
+ * @brief Gives the most recent allocation back to the arena (LIFO pop).
+ *
+ * Does nothing if `ptr` is not the last allocation of the current block, or if
+ * popping it would cross a block or record boundary.
+ *
+ * @return true if the memory was given back
+ */
+inline bool pop (Armel *armel, void *ptr, std::size_t bytes) noexcept {
+	uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+	uintptr_t base = reinterpret_cast<uintptr_t>(armel->base);
+	uintptr_t cursor = reinterpret_cast<uintptr_t>(armel->cursor);
+
+	// The cursor may sit on the padding left by a block popped just before
+	if (p < base || p + bytes > cursor || ((p + bytes + armel->mask) & ~armel->mask) < cursor) {
+		return false;
+	}
+	if (armel->offset + (p - base) < armel->floor) {
+		return false;
+	}
+
+	armel->cursor = ptr;
+	return true;
+}
+
+/**
+ * @class Arena
+ * @brief Owns an Armel for its lifetime; converts to `Armel*` for the C API.
+ */
+class Arena {
+public:
+	explicit Arena (std::size_t size) {
+		arl_new(&armel_, size);
+	}
+
+	Arena (std::size_t size, std::size_t alignment, uint8_t flags) {
+		arl_new_custom(&armel_, size, alignment, flags);
+	}
+
+	~Arena () {
+		arl_free(&armel_);
+	}
+
+	Arena (const Arena&) = delete;
+	Arena& operator= (const Arena&) = delete;
+
+	Armel* get () noexcept { return &armel_; }
+	operator Armel* () noexcept { return &armel_; }
+
+	void reset () noexcept { arl_reset(&armel_); }
+	std::size_t used () noexcept { return arl_used(&armel_); }
+
+private:
+	Armel armel_;
+};
+
+/**
+ * @class Scope
+ * @brief Rewinds an arena to its offset at construction when destroyed.
+ */
+class Scope {
+public:
+	explicit Scope (Armel *armel) noexcept
+		: armel_(armel), mark_(arl_offset(armel)) {}
+
+	~Scope () {
+		arl_rewind_to(armel_, mark_);
+	}
+
+	Scope (const Scope&) = delete;
+	Scope& operator= (const Scope&) = delete;
+
+	uintptr_t mark () const noexcept { return mark_; }
+
+private:
+	Armel *armel_;
+	uintptr_t mark_;
+};
+
+/**
+ * @class Resource
+ * @brief std::pmr::memory_resource backed by an Armel.
+ *
+ * The arena must outlive every container using the resource.
+ */
+class Resource : public std::pmr::memory_resource {
+public:
+	explicit Resource (Armel *armel) noexcept : armel_(armel) {}
+
+	Armel* arena () const noexcept { return armel_; }
+
+private:
+	void* do_allocate (std::size_t bytes, std::size_t align) override {
+		return armel::allocate(armel_, bytes, align);
+	}
+
+	void do_deallocate (void *ptr, std::size_t bytes, std::size_t) override {
+		armel::pop(armel_, ptr, bytes);
+	}
+
+	bool do_is_equal (const std::pmr::memory_resource &other) const noexcept override {
+		return this == &other;
+	}
+
+	Armel *armel_;
+};
+
+/**
+ * @class Allocator
+ * @brief STL allocator backed by an Armel, for containers without std::pmr.
+ */
+template <class T>
+class Allocator {
+public:
+	using value_type = T;
+
+	explicit Allocator (Armel *armel) noexcept : armel_(armel) {}
+
+	template <class U>
+	Allocator (const Allocator<U> &other) noexcept : armel_(other.arena()) {}
+
+	T* allocate (std::size_t n) {
+		if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+			throw std::bad_array_new_length();
+		}
+		return static_cast<T*>(armel::allocate(armel_, n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate (T *ptr, std::size_t n) noexcept {
+		armel::pop(armel_, ptr, n * sizeof(T));
+	}
+
+	Armel* arena () const noexcept { return armel_; }
+
+private:
+	Armel *armel_;
+};
+
+template <class T, class U>
+bool operator== (const Allocator<T> &a, const Allocator<U> &b) noexcept {
+	return a.arena() == b.arena();
+}
+
+template <class T, class U>
+bool operator!= (const Allocator<T> &a, const Allocator<U> &b) noexcept {
+	return a.arena() != b.arena();
+}
+
+/**
+ * @brief Allocates a T in the arena and constructs it with `args`.
+ *
+ * Non-trivial destructors are registered with arl_defer(): they run when the
+ * arena is reset, rewound before the object, or freed.
+ */
+template <class T, class... Args>
+T* make (Armel *armel, Args&&... args) {
+	void *ptr = armel::allocate(armel, sizeof(T), alignof(T));
+	T *object = ::new (ptr) T(std::forward<Args>(args)...);
+
+	if constexpr (!std::is_trivially_destructible_v<T>) {
+		if (!arl_defer(armel, [] (void *p) { static_cast<T*>(p)->~T(); }, object)) {
+			object->~T();
+			throw std::bad_alloc();
+		}
+	}
+	return object;
+}
+
+#if defined(__cpp_impl_coroutine)
+
+/**
+ * @brief Arena receiving the coroutine frames created on this thread (see Frames).
+ */
+inline thread_local Armel *frame_arena = nullptr;
+
+/**
+ * @class FrameScope
+ * @brief Routes coroutine frames created on this thread to `armel` while alive.
+ *
+ * Scopes nest: the previous arena is restored on destruction.
+ */
+class FrameScope {
+public:
+	explicit FrameScope (Armel *armel) noexcept : previous_(frame_arena) {
+		frame_arena = armel;
+	}
+
+	~FrameScope () {
+		frame_arena = previous_;
+	}
+
+	FrameScope (const FrameScope&) = delete;
+	FrameScope& operator= (const FrameScope&) = delete;
+
+private:
+	Armel *previous_;
+};
+
+/**
+ * @struct Frames
+ * @brief Promise-type mixin allocating coroutine frames from an arena.
+ *
+ * Inherit from it in a promise type. The frame comes from:
+ *   - the coroutine's first argument when it is an `Armel*`,
+ *   - otherwise the thread's FrameScope arena,
+ *   - otherwise the global heap.
+ *
+ * Frames that die in stack order (a chain of awaited calls) are popped from the
+ * arena; the rest is released with the arena, its scope or its reset.
+ *
+ * Example:
+ * ```cpp
+ * struct promise_type : armel::Frames { ... };
+ *
+ * armel::FrameScope frames(arena);
+ * run(handle_request());   // every nested frame is bump-allocated
+ * ```
+ */
+struct Frames {
+	/// Space before each frame, remembering where the frame came from
+	static constexpr std::size_t header = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+	static void* operator new (std::size_t size) {
+		return allocate_frame(frame_arena, size);
+	}
+
+	template <class... Args>
+	static void* operator new (std::size_t size, Armel *armel, Args&&...) {
+		return allocate_frame(armel, size);
+	}
+
+	template <class... Args>
+	static void operator delete (void *ptr, Armel*, Args&&...) noexcept {
+		operator delete(ptr, 0);
+	}
+
+	static void operator delete (void *ptr, std::size_t size) noexcept {
+		unsigned char *block = static_cast<unsigned char*>(ptr) - header;
+		Armel *armel = *reinterpret_cast<Armel**>(block);
+
+		if (armel == nullptr) {
+			::operator delete(block);
+		} else {
+			armel::pop(armel, block, header + size);
+		}
+	}
+
+private:
+	static void* allocate_frame (Armel *armel, std::size_t size) {
+		void *block = armel != nullptr
+			? armel::allocate(armel, header + size, header)
+			: ::operator new(header + size);
+
+		*static_cast<Armel**>(block) = armel;
+		return static_cast<unsigned char*>(block) + header;
+	}
+};
+
+#endif
+
+} // namespace armel
+
+#endif
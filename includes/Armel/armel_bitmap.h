@@ -0,0 +1,190 @@
+/**
+ * @file armel_bitmap.h
+ * @brief Fixed-size block allocator over arena pages, tracking free slots with bitmaps.
+ *
+ * An intrusive free list hands back the most recently freed slot, wherever it is:
+ * after random frees, consecutive allocations land all over memory. This allocator
+ * carves aligned pages from an arena instead and keeps one bit per slot. It
+ * allocates the lowest free slot of the current page with two `ctz` (one on a
+ * summary word, one on a bitmap word), so reuse stays packed at low addresses.
+ *
+ * Freeing clears nothing in the object and touches no other slot: it sets one bit
+ * in the page header, found by masking the pointer. A page whose slots are all
+ * free is given back to the arena if it is the arena's last allocation, and kept
+ * for the next page otherwise.
+ *
+ * Single-threaded: the pool is owned by the thread owning the arena.
+ *
+ * Example:
+ * ```c
+ * ArlBitmap nodes;
+ * arl_bitmap_new(&nodes, &armel, sizeof(Node), 0);
+ *
+ * Node* n = arl_bitmap_alloc(&nodes);
+ * arl_bitmap_free(&nodes, n);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_BITMAP_H
+#define ARMEL_BITMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_BITMAP_PAGE
+ * @brief Default page size in bytes (power of 2).
+ */
+#ifndef ARL_BITMAP_PAGE
+	#define ARL_BITMAP_PAGE (4 * ARL_KB)
+#endif
+
+/**
+ * @def ARL_BITMAP_SLOTS
+ * @brief Maximum slots per page: 64 bitmap words under one summary word.
+ */
+#define ARL_BITMAP_SLOTS 4096
+
+/**
+ * @struct ArlBitmapPage
+ * @brief Page header, at the start of each page.
+ *
+ * Fields:
+ *   - next, prev: Links in the pool's partial list (next only in the empty list)
+ *   - summary:    Bit w is set when free[w] has a free slot
+ *   - live:       Number of allocated slots
+ *   - free:       One bit per slot, set when the slot is free
+ */
+typedef struct ArlBitmapPage {
+	struct ArlBitmapPage *next;
+	struct ArlBitmapPage *prev;
+	uint64_t summary;
+	uint32_t live;
+	uint64_t free[];
+} ArlBitmapPage;
+
+/**
+ * @struct ArlBitmap
+ * @brief Bitmap block allocator.
+ *
+ * Fields:
+ *   - armel:   Arena the pages are carved from
+ *   - size:    Slot size, rounded up to the arena alignment
+ *   - page:    Page size (power of 2, pages are aligned to it)
+ *   - header:  Offset of the first slot in a page
+ *   - slots:   Slots per page
+ *   - scale:   ceil(2^32 / size), turning a page offset into a slot index without dividing
+ *   - current: Page allocations come from
+ *   - partial: Other pages with free slots
+ *   - empty:   Pages with no live slot, kept for reuse
+ */
+typedef struct {
+	Armel *armel;
+	size_t size;
+	size_t page;
+	size_t header;
+	uint32_t slots;
+	uint64_t scale;
+	ArlBitmapPage *current;
+	ArlBitmapPage *partial;
+	ArlBitmapPage *empty;
+} ArlBitmap;
+
+/**
+ * @brief Creates a bitmap allocator of `size`-byte blocks.
+ *
+ * @param pool  Pointer to the allocator to initialize
+ * @param armel Arena the pages are carved from
+ * @param size  Block size in bytes
+ * @param page  Page size (power of 2), or 0 for ARL_BITMAP_PAGE
+ */
+void arl_bitmap_new (ArlBitmap *pool, Armel *armel, size_t size, size_t page);
+
+/**
+ * @brief Switches to another page with free slots, carving one if needed.
+ *
+ * Called by arl_bitmap_alloc() when the current page is full.
+ *
+ * @return Pointer to a block, or NULL if the arena is full (with ARL_SOFTFAIL)
+ */
+void* arl_bitmap_refill (ArlBitmap *pool);
+
+/**
+ * @brief Moves a page between lists after a free made it partial or empty.
+ *
+ * Called by arl_bitmap_free().
+ */
+void arl_bitmap_settle (ArlBitmap *pool, ArlBitmapPage *page, int was_full);
+
+static inline unsigned arl_bitmap_ctz (uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_ctzll(word);
+#else
+	unsigned bit = 0;
+	while (!(word & 1)) {
+		word >>= 1;
+		bit++;
+	}
+	return bit;
+#endif
+}
+
+/**
+ * @brief Allocates a block: the lowest free slot of the current page.
+ *
+ * @param pool Pointer to the allocator
+ * @return Pointer to an uninitialized block, or NULL if the arena is full (with ARL_SOFTFAIL)
+ */
+static inline void* arl_bitmap_alloc (ArlBitmap *pool) {
+	ArlBitmapPage *page = pool->current;
+
+	if (page == NULL || page->summary == 0) {
+		return arl_bitmap_refill(pool);
+	}
+
+	unsigned word = arl_bitmap_ctz(page->summary);
+	uint64_t bits = page->free[word];
+	unsigned bit = arl_bitmap_ctz(bits);
+
+	page->free[word] = bits & (bits - 1);
+	if (page->free[word] == 0) {
+		page->summary &= page->summary - 1;
+	}
+	page->live++;
+
+	return (uint8_t*)page + pool->header + ((size_t)word * 64 + bit) * pool->size;
+}
+
+/**
+ * @brief Frees a block.
+ *
+ * @param pool Pointer to the allocator
+ * @param ptr  Block returned by arl_bitmap_alloc()
+ */
+static inline void arl_bitmap_free (ArlBitmap *pool, void *ptr) {
+	ArlBitmapPage *page = (ArlBitmapPage*)((uintptr_t)ptr & ~(uintptr_t)(pool->page - 1));
+	uint64_t offset = (uint64_t)((uint8_t*)ptr - (uint8_t*)page - pool->header);
+	uint32_t slot = (uint32_t)((offset * pool->scale) >> 32);
+	int was_full = page->live == pool->slots;
+
+	page->free[slot / 64] |= (uint64_t)1 << (slot % 64);
+	page->summary |= (uint64_t)1 << (slot / 64);
+	page->live--;
+
+	if (was_full || page->live == 0) {
+		arl_bitmap_settle(pool, page, was_full);
+	}
+}
+
+/**
+ * @brief Forgets every page, after the arena was reset.
+ *
+ * @param pool Pointer to the allocator
+ */
+void arl_bitmap_reset (ArlBitmap *pool);
+
+#endif
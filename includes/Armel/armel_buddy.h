@@ -0,0 +1,155 @@
+/**
+ * @file armel_buddy.h
+ * @brief Buddy allocator for power-of-two buffers (4 KB to 4 MB) that are freed and coalesced.
+ *
+ * Manages one region, taken from an arena or from a dedicated system mapping.
+ * Requests are rounded up to a power of two. A larger free block is split in
+ * halves until it fits; a freed block merges with its buddy (the other half of
+ * its parent) as long as the buddy is free too. Both walk at most one step per
+ * order: O(log n).
+ *
+ * Each order has a free list, threaded through the free blocks themselves, and
+ * a bitmap with one bit per block telling whether it is on that list. The
+ * bitmaps live outside the region, so blocks keep the region's alignment: give
+ * a page alignment for buffers used with O_DIRECT.
+ *
+ * Big buffer churn stays off malloc, whose mmap threshold would otherwise map
+ * and unmap them (with page faults on every reuse).
+ *
+ * Example:
+ * ```c
+ * ArlBuddy buffers;
+ * arl_buddy_new_mapped(&buffers, 64 * ARL_MB);
+ *
+ * void* io = arl_buddy_alloc(&buffers, 256 * ARL_KB);
+ * read(fd, io, 256 * ARL_KB);
+ * arl_buddy_free(&buffers, io, 256 * ARL_KB);
+ *
+ * arl_buddy_destroy(&buffers);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_BUDDY_H
+#define ARMEL_BUDDY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_BUDDY_MIN_SHIFT
+ * @brief log2 of the smallest block (4 KB).
+ */
+#ifndef ARL_BUDDY_MIN_SHIFT
+	#define ARL_BUDDY_MIN_SHIFT 12
+#endif
+
+/**
+ * @def ARL_BUDDY_MAX_SHIFT
+ * @brief log2 of the largest block (4 MB).
+ */
+#ifndef ARL_BUDDY_MAX_SHIFT
+	#define ARL_BUDDY_MAX_SHIFT 22
+#endif
+
+#define ARL_BUDDY_MIN ((size_t)1 << ARL_BUDDY_MIN_SHIFT)
+#define ARL_BUDDY_MAX ((size_t)1 << ARL_BUDDY_MAX_SHIFT)
+#define ARL_BUDDY_ORDERS (ARL_BUDDY_MAX_SHIFT - ARL_BUDDY_MIN_SHIFT + 1)
+
+/**
+ * @struct ArlBuddyNode
+ * @brief Free-list links, stored in the first bytes of a free block.
+ */
+typedef struct ArlBuddyNode {
+	struct ArlBuddyNode *next;
+	struct ArlBuddyNode *prev;
+} ArlBuddyNode;
+
+/**
+ * @struct ArlBuddy
+ * @brief Buddy allocator over one region.
+ *
+ * Fields:
+ *   - base:      Start of the region (block offsets are relative to it)
+ *   - size:      Managed bytes (a multiple of ARL_BUDDY_MIN)
+ *   - available: Free bytes
+ *   - free:      Free list per order (order k holds blocks of ARL_BUDDY_MIN << k bytes)
+ *   - bits:      Bitmap per order, bit i set when block i of that order is free
+ *   - mapping, mapped, tag: Dedicated mapping to unmap on destroy (NULL for an arena region)
+ */
+typedef struct {
+	uint8_t *base;
+	size_t size;
+	size_t available;
+	ArlBuddyNode *free[ARL_BUDDY_ORDERS];
+	uint64_t *bits[ARL_BUDDY_ORDERS];
+	void *mapping;
+	size_t mapped;
+	int tag;
+} ArlBuddy;
+
+/**
+ * @brief Creates a buddy allocator over a region carved from an arena.
+ *
+ * The region and the bitmaps live until the arena is reset or freed.
+ *
+ * @param buddy     Pointer to the allocator to initialize
+ * @param armel     Arena providing the region
+ * @param size      Region size in bytes (rounded down to ARL_BUDDY_MIN)
+ * @param alignment Alignment of every block (power of 2, at most ARL_BUDDY_MIN), or 0 for the arena's
+ * @return 1 on success, 0 if the arena could not provide the region (with ARL_SOFTFAIL)
+ */
+int arl_buddy_new (ArlBuddy *buddy, Armel *armel, size_t size, size_t alignment);
+
+/**
+ * @brief Creates a buddy allocator over a dedicated system mapping.
+ *
+ * Blocks are page-aligned. The mapping is charged to the thread's budget tag
+ * (see arl_budget_use) and returned by arl_buddy_destroy().
+ *
+ * @param buddy Pointer to the allocator to initialize
+ * @param size  Region size in bytes (rounded up to ARL_BUDDY_MIN)
+ * @return 1 on success, 0 if the system or the memory budget refused the mapping
+ */
+int arl_buddy_new_mapped (ArlBuddy *buddy, size_t size);
+
+/**
+ * @brief Returns the dedicated mapping to the system (no-op for an arena region).
+ *
+ * @param buddy Pointer to the allocator
+ */
+void arl_buddy_destroy (ArlBuddy *buddy);
+
+/**
+ * @brief Allocates a block of at least `size` bytes.
+ *
+ * @param buddy Pointer to the allocator
+ * @param size  Requested size, rounded up to a power of 2 of at least ARL_BUDDY_MIN
+ * @return Pointer to the block, or NULL if size exceeds ARL_BUDDY_MAX or no block is free
+ */
+void* arl_buddy_alloc (ArlBuddy *buddy, size_t size);
+
+/**
+ * @brief Frees a block, merging it with its free buddies.
+ *
+ * @param buddy Pointer to the allocator
+ * @param ptr   Block returned by arl_buddy_alloc()
+ * @param size  Size given to arl_buddy_alloc()
+ */
+void arl_buddy_free (ArlBuddy *buddy, void *ptr, size_t size);
+
+/**
+ * @brief Returns the size of the block serving a `size`-byte request.
+ */
+static inline size_t arl_buddy_block_size (size_t size) {
+	size_t block = ARL_BUDDY_MIN;
+	while (block < size) {
+		block <<= 1;
+	}
+	return block;
+}
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @file armel_clone.h
+ * @brief Copies the objects reachable from a root out of a scratch arena, into a tight arena.
+ *
+ * Results built in a large scratch arena sit among temporaries. Cloning copies
+ * only what the result reaches, packed back to back (each object keeps its
+ * alignment), and rewrites the pointers between copies. The scratch arena can
+ * be reset right after.
+ *
+ * The object graph is described by relocation callbacks: for each object, the
+ * callback reports its pointer fields with arl_clone_ref(). Cloning runs it
+ * twice per object: once on the original, to find and measure every reachable
+ * object, then on the copy, to rewrite the fields. Shared objects and cycles are
+ * copied once.
+ *
+ * Example:
+ * ```c
+ * static void relocate_node (ArlClone* clone, void* object) {
+ *     Node* node = object;
+ *     arl_clone_ref(clone, &node->next, sizeof(Node), alignof(Node), relocate_node);
+ *     arl_clone_ref(clone, &node->name, strlen(node->name) + 1, 1, NULL);
+ * }
+ *
+ * Armel cache;
+ * Node* kept = arl_clone_new(&cache, &scratch, head, sizeof(Node), alignof(Node), relocate_node);
+ * arl_reset(&scratch);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_CLONE_H
+#define ARMEL_CLONE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Armel/armel.h>
+
+/**
+ * @brief Cloning state, passed to relocation callbacks.
+ */
+typedef struct ArlClone ArlClone;
+
+/**
+ * @brief Reports the pointer fields of `object` with arl_clone_ref().
+ *
+ * Called on the original, then on its copy: it must only read the object and
+ * what its fields point to (still the originals in both calls).
+ */
+typedef void (*ArlRelocateFn) (ArlClone *clone, void *object);
+
+/**
+ * @brief Copies `size` bytes into the arena.
+ *
+ * @param dst  Destination arena
+ * @param ptr  Start of the range
+ * @param size Length in bytes
+ * @return The copy, or NULL if `dst` had no room (with ARL_SOFTFAIL)
+ */
+void* arl_clone_range (Armel *dst, const void *ptr, size_t size);
+
+/**
+ * @brief Reports a pointer field from a relocation callback.
+ *
+ * @param clone    State passed to the callback
+ * @param field    Address of the pointer field (a `T**` passed as `void*`); NULL pointers are skipped
+ * @param size     Size of the object it points to
+ * @param align    Alignment of that object (power of 2)
+ * @param relocate Callback for that object's own fields, or NULL if it has none
+ */
+void arl_clone_ref (ArlClone *clone, void *field, size_t size, size_t align, ArlRelocateFn relocate);
+
+/**
+ * @brief Deep-copies the graph reachable from `root` into a new arena of exactly the right size.
+ *
+ * @param dst      Arena to create (uninitialized; free it with arl_free, even after a NULL return)
+ * @param scratch  Arena for the bookkeeping (typically the source arena, about to be reset)
+ * @param root     Object to copy
+ * @param size     Size of the root
+ * @param align    Alignment of the root
+ * @param relocate Callback for the root's fields, or NULL
+ * @return The copy of the root, or NULL if `root` is NULL or memory ran out (ARL_SOFTFAIL scratch)
+ */
+void* arl_clone_new (Armel *dst, Armel *scratch, const void *root, size_t size, size_t align, ArlRelocateFn relocate);
+
+/**
+ * @brief Deep-copies the graph reachable from `root` into one packed allocation of an existing arena.
+ *
+ * Same as arl_clone_new(), for a destination that already exists.
+ */
+void* arl_clone (Armel *dst, Armel *scratch, const void *root, size_t size, size_t align, ArlRelocateFn relocate);
+
+#endif
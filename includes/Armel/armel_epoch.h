@@ -0,0 +1,181 @@
+/**
+ * @file armel_epoch.h
+ * @brief Epoch-based reclamation for arenas shared with concurrent readers.
+ *
+ * A writer builds immutable data in an arena, publishes it to reader threads,
+ * and later retires the whole arena. The arena is only reset (or handed to a
+ * recycle callback) once every reader that could still see it has left its
+ * read section.
+ *
+ * Readers enter and exit read sections by writing their own epoch slot, which
+ * lives on its own cache line: there are no shared writes on the read path.
+ *
+ * Example:
+ * ```c
+ * ArlEpoch domain;
+ * arl_epoch_init(&domain);
+ *
+ * // Reader thread
+ * ArlEpochReader* me = arl_epoch_register(&domain);
+ * arl_epoch_enter(&domain, me);
+ * const Snapshot* snap = atomic_load(&current);
+ * use(snap);
+ * arl_epoch_exit(me);
+ *
+ * // Writer thread
+ * atomic_store(&current, next_snapshot);
+ * arl_epoch_retire(&domain, &old_arena, NULL, NULL); // reset once readers are done
+ * arl_epoch_reclaim(&domain);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_EPOCH_H
+#define ARMEL_EPOCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_EPOCH_MAX_READERS
+ * @brief Maximum number of reader slots per epoch domain.
+ */
+#ifndef ARL_EPOCH_MAX_READERS
+	#define ARL_EPOCH_MAX_READERS 64
+#endif
+
+/**
+ * @brief Called when a retired arena becomes safe to reuse.
+ *
+ * When no callback is given to arl_epoch_retire(), the arena is simply reset.
+ */
+typedef void (*ArlRetireFn) (Armel *armel, void *ctx);
+
+/**
+ * @struct ArlEpochReader
+ * @brief Per-thread reader slot, alone on its cache line.
+ *
+ * Fields:
+ *   - epoch: Epoch observed when entering a read section (0 when outside)
+ *   - used:  Non-zero while the slot is registered
+ */
+typedef struct {
+	_Alignas(ARL_CACHE_LINE) _Atomic uint64_t epoch;
+	_Atomic int used;
+} ArlEpochReader;
+
+/**
+ * @struct ArlRetired
+ * @brief Arena waiting for readers to advance (internal).
+ */
+typedef struct ArlRetired {
+	struct ArlRetired *next;
+	Armel *armel;
+	ArlRetireFn fn;
+	void *ctx;
+	uint64_t epoch;
+} ArlRetired;
+
+/**
+ * @struct ArlEpoch
+ * @brief Epoch domain shared by a set of readers and writers.
+ *
+ * Fields:
+ *   - global:     Current epoch, advanced on every retirement
+ *   - retired:    Lock-free stack of arenas waiting to be reclaimed
+ *   - reclaiming: Guard so that a single thread reclaims at a time
+ *   - readers:    Reader slots
+ */
+typedef struct {
+	_Alignas(ARL_CACHE_LINE) _Atomic uint64_t global;
+	_Atomic(ArlRetired*) retired;
+	_Atomic int reclaiming;
+	ArlEpochReader readers[ARL_EPOCH_MAX_READERS];
+} ArlEpoch;
+
+/**
+ * @brief Initializes an epoch domain.
+ *
+ * @param domain Pointer to the domain to initialize
+ */
+void arl_epoch_init (ArlEpoch *domain);
+
+/**
+ * @brief Claims a reader slot for the calling thread.
+ *
+ * @param domain Pointer to the domain
+ * @return The reader slot, or NULL if all ARL_EPOCH_MAX_READERS slots are taken
+ */
+ArlEpochReader* arl_epoch_register (ArlEpoch *domain);
+
+/**
+ * @brief Releases a reader slot. The reader must be outside of any read section.
+ *
+ * @param reader Slot returned by arl_epoch_register()
+ */
+void arl_epoch_unregister (ArlEpochReader *reader);
+
+/**
+ * @brief Enters a read section.
+ *
+ * Publishes the current epoch in the reader's own slot. Arenas retired after this
+ * point will not be reclaimed until arl_epoch_exit() is called.
+ *
+ * @param domain Pointer to the domain
+ * @param reader Calling thread's slot
+ */
+static inline void arl_epoch_enter (ArlEpoch *domain, ArlEpochReader *reader) {
+	uint64_t epoch = atomic_load_explicit(&domain->global, memory_order_relaxed);
+	atomic_store_explicit(&reader->epoch, epoch, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+}
+
+/**
+ * @brief Leaves a read section. Pointers read inside it must no longer be used.
+ *
+ * @param reader Calling thread's slot
+ */
+static inline void arl_epoch_exit (ArlEpochReader *reader) {
+	atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+/**
+ * @brief Retires an arena whose contents are no longer reachable by new readers.
+ *
+ * The arena must already be unpublished. It is handed to `fn` (or reset if `fn`
+ * is NULL) by a later arl_epoch_reclaim() once all readers have advanced.
+ * Safe to call from several writer threads.
+ *
+ * @param domain Pointer to the domain
+ * @param armel  Arena to retire
+ * @param fn     Recycle callback, or NULL to reset the arena
+ * @param ctx    User context passed to the callback
+ */
+void arl_epoch_retire (ArlEpoch *domain, Armel *armel, ArlRetireFn fn, void *ctx);
+
+/**
+ * @brief Reclaims every retired arena that no reader can still see.
+ *
+ * Returns immediately if another thread is already reclaiming.
+ *
+ * @param domain Pointer to the domain
+ * @return Number of arenas reclaimed
+ */
+size_t arl_epoch_reclaim (ArlEpoch *domain);
+
+/**
+ * @brief Waits until every retired arena has been reclaimed.
+ *
+ * Spins until it finds the retired stack empty while holding the reclaiming
+ * guard, so arenas detached by a concurrent arl_epoch_reclaim() have been
+ * released too when it returns. Meant for shutdown paths.
+ *
+ * @param domain Pointer to the domain
+ */
+void arl_epoch_drain (ArlEpoch *domain);
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * @file armel_file.h
+ * @brief Loads files into arena memory, and splits them into zero-copy slices.
+ *
+ * arl_read_file() picks a strategy by size:
+ *   - small files are read into the arena with one read() (no intermediate buffer);
+ *   - large files are mapped read-only (prefaulted with MAP_POPULATE on Linux,
+ *     advised for sequential access) and unmapped when the arena is reset,
+ *     rewound before the call, or freed (see arl_defer).
+ *
+ * arl_read_file_mode() forces a strategy, including ARL_FILE_DIRECT: an O_DIRECT
+ * read into page-aligned arena memory that bypasses the page cache (Linux; other
+ * systems, and file systems refusing O_DIRECT, fall back to ARL_FILE_READ).
+ *
+ * Files without a usable size (pipes, FIFOs, procfs and sysfs files, which report
+ * 0) are read to the end whatever the mode, into a buffer that grows at the
+ * arena's tail.
+ *
+ * The split helpers walk a buffer without copying: every slice points into it.
+ *
+ * Example:
+ * ```c
+ * size_t len;
+ * const char* csv = arl_read_file(&arena, "data.csv", &len);
+ *
+ * ArlSlice rest = { csv, len }, line;
+ * while (arl_next_line(&rest, &line)) {
+ *     parse_row(line.ptr, line.len);
+ * }
+ * arl_reset(&arena); // releases the buffer, or unmaps the file
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_FILE_H
+#define ARMEL_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_FILE_MAP_THRESHOLD
+ * @brief Files of at least this size are mapped by arl_read_file() instead of read.
+ */
+#ifndef ARL_FILE_MAP_THRESHOLD
+	#define ARL_FILE_MAP_THRESHOLD (ARL_MB)
+#endif
+
+/**
+ * @enum ArlFileMode
+ * @brief How arl_read_file_mode() loads a file.
+ */
+typedef enum {
+	ARL_FILE_AUTO,   // read below ARL_FILE_MAP_THRESHOLD, map above
+	ARL_FILE_READ,   // read() into the arena, followed by a NUL byte
+	ARL_FILE_MAP,    // read-only mapping tied to the arena's lifetime
+	ARL_FILE_DIRECT  // O_DIRECT read() into page-aligned arena memory
+} ArlFileMode;
+
+/**
+ * @brief Loads a whole file, choosing the strategy from its size.
+ *
+ * @param armel Arena owning the contents
+ * @param path  File to load
+ * @param len   Receives the file size
+ * @return The contents (read-only when mapped), or NULL if the file could not be
+ *         read or the arena had no room (with ARL_SOFTFAIL)
+ */
+const void* arl_read_file (Armel *armel, const char *path, size_t *len);
+
+/**
+ * @brief Loads a whole file with a given strategy (see ArlFileMode).
+ */
+const void* arl_read_file_mode (Armel *armel, const char *path, size_t *len, ArlFileMode mode);
+
+/**
+ * @struct ArlSlice
+ * @brief View into a buffer.
+ */
+typedef struct {
+	const char *ptr;
+	size_t len;
+} ArlSlice;
+
+/**
+ * @brief Cuts the next record ending with `delimiter` off the front of `rest`.
+ *
+ * The delimiter is consumed but not part of the record. The last record may
+ * end without one.
+ *
+ * @param rest      Remaining input, advanced past the record
+ * @param delimiter Byte ending each record
+ * @param record    Receives the record
+ * @return 1 if a record was cut, 0 once `rest` is empty
+ */
+static inline int arl_next_record (ArlSlice *rest, char delimiter, ArlSlice *record) {
+	if (rest->len == 0) {
+		return 0;
+	}
+
+	const char *stop = (const char*)memchr(rest->ptr, delimiter, rest->len);
+	size_t len = stop ? (size_t)(stop - rest->ptr) : rest->len;
+	size_t consumed = stop ? len + 1 : len;
+
+	record->ptr = rest->ptr;
+	record->len = len;
+	rest->ptr += consumed;
+	rest->len -= consumed;
+	return 1;
+}
+
+/**
+ * @brief Cuts the next line off the front of `rest`, without its "\n" or "\r\n".
+ */
+static inline int arl_next_line (ArlSlice *rest, ArlSlice *line) {
+	if (!arl_next_record(rest, '\n', line)) {
+		return 0;
+	}
+	if (line->len > 0 && line->ptr[line->len - 1] == '\r') {
+		line->len--;
+	}
+	return 1;
+}
+
+/**
+ * @brief Cuts the next `size`-byte record off the front of `rest` (the last one may be shorter).
+ */
+static inline int arl_next_fixed (ArlSlice *rest, size_t size, ArlSlice *record) {
+	if (rest->len == 0) {
+		return 0;
+	}
+
+	size_t len = rest->len < size ? rest->len : size;
+	record->ptr = rest->ptr;
+	record->len = len;
+	rest->ptr += len;
+	rest->len -= len;
+	return 1;
+}
+
+#endif
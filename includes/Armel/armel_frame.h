@@ -0,0 +1,155 @@
+/**
+ * @file armel_frame.h
+ * @brief Double- and N-buffered frame arenas with automatic rotation.
+ *
+ * A frame ring holds N arenas. Allocations go to the current one; advancing to
+ * the next frame resets the oldest arena and makes it current. Data allocated
+ * during a frame therefore stays valid for the next N-1 frames, which replaces
+ * hand-rolled ping-pong buffers (N = 2) for frame- and batch-based workers.
+ *
+ * The ring tracks the usage of each frame and can resize its arenas from the
+ * observed peaks: arenas that had to chain blocks grow, oversized ones shrink.
+ *
+ * Example:
+ * ```c
+ * ArlFrameRing frames;
+ * arl_frame_new(&frames, 2, 64 * ARL_KB, ARL_NOFLAG);
+ *
+ * for (;;) {
+ *     Armel* frame = arl_frame_current(&frames);
+ *     State* state = arl_make(frame, State);
+ *     ...
+ *     arl_frame_advance(&frames); // previous frame is still readable
+ * }
+ *
+ * arl_frame_free(&frames);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_FRAME_H
+#define ARMEL_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_FRAME_MAX
+ * @brief Maximum number of arenas in a frame ring.
+ */
+#ifndef ARL_FRAME_MAX
+	#define ARL_FRAME_MAX 8
+#endif
+
+/**
+ * @def ARL_FRAME_HISTORY
+ * @brief Number of past frame peaks used to size arenas adaptively.
+ */
+#ifndef ARL_FRAME_HISTORY
+	#define ARL_FRAME_HISTORY 16
+#endif
+
+/**
+ * @def ARL_FRAME_ADAPTIVE
+ * @brief Resize arenas from observed frame peaks when they are recycled.
+ *
+ * Ring-only flag, stripped before the arenas are created.
+ */
+#define ARL_FRAME_ADAPTIVE 0x80
+
+/**
+ * @struct ArlFrameRing
+ * @brief Ring of N arenas rotated once per frame.
+ *
+ * Fields:
+ *   - arenas:    The N arenas; arenas[current] receives the allocations
+ *   - count:     Number of arenas in the ring
+ *   - current:   Index of the current arena
+ *   - frame:     Number of completed frames
+ *   - history:   Peak usage of the last ARL_FRAME_HISTORY frames
+ *   - last_peak: Usage of the last completed frame
+ *   - max_peak:  Largest frame usage seen so far
+ *   - min_size:  Initial arena size, lower bound when shrinking
+ *   - alignment, flags: Settings applied when arenas are (re)created
+ */
+typedef struct {
+	Armel arenas[ARL_FRAME_MAX];
+	size_t count;
+	size_t current;
+	uint64_t frame;
+	size_t history[ARL_FRAME_HISTORY];
+	size_t last_peak;
+	size_t max_peak;
+	size_t min_size;
+	size_t alignment;
+	uint8_t flags;
+} ArlFrameRing;
+
+/**
+ * @brief Creates a ring of `count` arenas of `size` bytes each.
+ *
+ * Unless ARL_SOFTFAIL is given, the arenas chain new blocks instead of aborting
+ * when a frame outgrows them (see arl_overflow_grow).
+ *
+ * @param ring  Pointer to the ring to initialize
+ * @param count Number of arenas (2 for double buffering, at most ARL_FRAME_MAX)
+ * @param size  Initial capacity of each arena in bytes
+ * @param flags Arena flags, plus ARL_FRAME_ADAPTIVE to resize arenas from frame peaks
+ */
+void arl_frame_new (ArlFrameRing *ring, size_t count, size_t size, uint8_t flags);
+
+/**
+ * @brief Releases all arenas of the ring.
+ *
+ * @param ring Pointer to the ring
+ */
+void arl_frame_free (ArlFrameRing *ring);
+
+/**
+ * @brief Returns the arena of the current frame.
+ *
+ * @param ring Pointer to the ring
+ * @return Arena receiving this frame's allocations
+ */
+static inline Armel* arl_frame_current (ArlFrameRing *ring) {
+	return &ring->arenas[ring->current];
+}
+
+/**
+ * @brief Ends the current frame: resets the oldest arena and makes it current.
+ *
+ * Records the usage of the frame that just ended and, with ARL_FRAME_ADAPTIVE,
+ * resizes the recycled arena from the recent peaks.
+ *
+ * @param ring Pointer to the ring
+ * @return The new current arena
+ *
+ * @note Usage is sampled at the end of the frame: memory rewound during the
+ *       frame is not counted in its peak.
+ */
+Armel* arl_frame_advance (ArlFrameRing *ring);
+
+/**
+ * @brief Copies an allocation into the current frame so it survives one more frame.
+ *
+ * @param ring Pointer to the ring
+ * @param ptr  Allocation from a previous frame
+ * @param size Size of the allocation in bytes
+ * @return Pointer to the copy, or NULL if the current arena cannot hold it
+ */
+void* arl_frame_promote (ArlFrameRing *ring, const void *ptr, size_t size);
+
+/**
+ * @brief Returns the usage of the last completed frame.
+ *
+ * @param ring Pointer to the ring
+ * @return Bytes used by the previous frame
+ */
+static inline size_t arl_frame_peak (ArlFrameRing *ring) {
+	return ring->last_peak;
+}
+
+#endif
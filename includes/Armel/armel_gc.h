@@ -0,0 +1,176 @@
+/**
+ * @file armel_gc.h
+ * @brief Optional semi-space copying collector over two arenas.
+ *
+ * Long-lived data that is replaced piece by piece (caches, indexes) accumulates
+ * garbage in an arena that is never reset. The collector allocates from one
+ * arena at a time; arl_collect() copies the objects still reachable from the
+ * registered roots into the other arena (Cheney's breadth-first copy, scanning
+ * the copies in place), resets the old arena and swaps them. The pause depends on
+ * the live data only, not on how much garbage accumulated.
+ *
+ * Objects carry a small header naming their type. A type's trace function
+ * reports the object's pointer fields with arl_gc_relocate(), which updates them
+ * to the copies. Pointers to memory outside the collected arena are left alone.
+ * Roots and traced fields must point to the start of an object (as returned by
+ * arl_gc_alloc): an interior pointer, into an array or an embedded field, would
+ * be read as a header. ARL_CHECK catches most of them, not all.
+ *
+ * Collection only happens in arl_collect(): pointers held outside the roots are
+ * invalid afterwards.
+ *
+ * Example:
+ * ```c
+ * static void trace_entry (ArlGc* gc, void* object) {
+ *     Entry* e = object;
+ *     arl_gc_relocate(gc, &e->next);
+ *     arl_gc_relocate(gc, &e->value);
+ * }
+ * static const ArlGcType entry_type = { sizeof(Entry), trace_entry };
+ *
+ * ArlGc gc;
+ * arl_gc_new(&gc, 64 * ARL_MB);
+ * arl_gc_root(&gc, &cache_head);
+ *
+ * Entry* e = arl_gc_alloc(&gc, &entry_type, 0);
+ * if (e == NULL) { arl_collect(&gc); e = arl_gc_alloc(&gc, &entry_type, 0); }
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_GC_H
+#define ARMEL_GC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_GC_ROOTS
+ * @brief Maximum number of registered roots.
+ */
+#ifndef ARL_GC_ROOTS
+	#define ARL_GC_ROOTS 64
+#endif
+
+typedef struct ArlGc ArlGc;
+
+/**
+ * @brief Reports each pointer field of `object` with arl_gc_relocate().
+ */
+typedef void (*ArlTraceFn) (ArlGc *gc, void *object);
+
+/**
+ * @struct ArlGcType
+ * @brief Layout of a collected object.
+ *
+ * Fields:
+ *   - size:  Default object size (arl_gc_alloc with size 0)
+ *   - trace: Pointer fields of the object, or NULL if it has none
+ */
+typedef struct {
+	size_t size;
+	ArlTraceFn trace;
+} ArlGcType;
+
+/**
+ * @struct ArlGcHeader
+ * @brief Header before each object: its type (or, once copied, its new address) and size.
+ */
+typedef struct {
+	uintptr_t type;
+	size_t size;
+} ArlGcHeader;
+
+/**
+ * @struct ArlGcStats
+ * @brief Report of the last collection.
+ *
+ * Fields:
+ *   - copied:    Bytes copied (live data, headers included)
+ *   - reclaimed: Bytes released with the old space
+ *   - objects:   Objects copied
+ *   - pause_ns:  Duration of the collection
+ */
+typedef struct {
+	size_t copied;
+	size_t reclaimed;
+	size_t objects;
+	uint64_t pause_ns;
+} ArlGcStats;
+
+/**
+ * @struct ArlGc
+ * @brief Two semi-spaces, roots and statistics.
+ *
+ * Fields:
+ *   - spaces:      The two arenas
+ *   - current:     Index of the arena objects are allocated from
+ *   - roots:       Addresses of the root pointers
+ *   - root_count:  Number of roots
+ *   - stats:       Report of the last collection
+ *   - collections: Number of collections so far
+ */
+struct ArlGc {
+	Armel spaces[2];
+	int current;
+	void **roots[ARL_GC_ROOTS];
+	size_t root_count;
+	ArlGcStats stats;
+	size_t collections;
+};
+
+/**
+ * @brief Creates a collector with two `size`-byte semi-spaces.
+ */
+void arl_gc_new (ArlGc *gc, size_t size);
+
+/**
+ * @brief Frees both semi-spaces.
+ */
+void arl_gc_free (ArlGc *gc);
+
+/**
+ * @brief Allocates an object in the current semi-space.
+ *
+ * @param gc   Pointer to the collector
+ * @param type Object type (must outlive the collector)
+ * @param size Object size, or 0 for type->size
+ * @return The object (uninitialized), or NULL if the semi-space is full: collect and retry
+ */
+void* arl_gc_alloc (ArlGc *gc, const ArlGcType *type, size_t size);
+
+/**
+ * @brief Registers the address of a pointer to a collected object (a `T**`).
+ *
+ * @return 1 on success, 0 if ARL_GC_ROOTS roots are already registered
+ */
+int arl_gc_root (ArlGc *gc, void *root);
+
+/**
+ * @brief Unregisters a root.
+ */
+void arl_gc_unroot (ArlGc *gc, void *root);
+
+/**
+ * @brief Copies the object a field points to, if not done yet, and updates the field.
+ *
+ * Called from trace functions. NULL and pointers outside the semi-space are left alone;
+ * pointers inside it must point to the start of an object.
+ *
+ * @param gc    Pointer to the collector
+ * @param field Address of the pointer field (a `T**` passed as `void*`)
+ */
+void arl_gc_relocate (ArlGc *gc, void *field);
+
+/**
+ * @brief Copies the live objects into the other semi-space and resets the old one.
+ *
+ * @param gc Pointer to the collector
+ * @return Statistics of this collection (also kept in gc->stats)
+ */
+ArlGcStats arl_collect (ArlGc *gc);
+
+#endif
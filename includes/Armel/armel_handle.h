@@ -0,0 +1,228 @@
+/**
+ * @file armel_handle.h
+ * @brief Generational handle pool: dense storage with stable, use-after-free-safe handles.
+ *
+ * Objects live in a dense array, so iterating over live objects walks contiguous
+ * memory. Callers hold handles instead of pointers: a handle names a slot in a
+ * sparse index and carries the slot's generation. Freeing an object moves the last
+ * dense object into its place (swap-remove) and bumps the slot's generation, so
+ * stale handles are detected instead of reaching another object.
+ *
+ * Allocation, lookup and free are O(1). The arrays are carved from an arena at
+ * creation, for a fixed capacity.
+ *
+ * Handles are 64-bit (32-bit index, 32-bit generation). Define ARL_HANDLE_32 for
+ * 32-bit handles (20-bit index, 12-bit generation).
+ *
+ * A generation never wraps: a slot whose generation is exhausted is retired on its
+ * last free instead of going back to the free list, so a stale handle can never
+ * validate again. Each retirement costs one unit of capacity; with ARL_HANDLE_32 a
+ * slot retires after 4095 frees, with 64-bit handles after 2^32 - 1.
+ *
+ * Example:
+ * ```c
+ * ArlHandlePool bodies;
+ * arl_handle_pool_new(&bodies, &armel, sizeof(Body), 10000);
+ *
+ * ArlHandle h = arl_handle_alloc(&bodies);
+ * Body* body = arl_handle_get(&bodies, h);
+ *
+ * Body* all = arl_handle_items(&bodies);
+ * for (size_t i = 0; i < bodies.count; i++) integrate(&all[i]);
+ *
+ * arl_handle_free(&bodies, h);
+ * assert(arl_handle_get(&bodies, h) == NULL);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_HANDLE_H
+#define ARMEL_HANDLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <Armel/armel.h>
+
+#ifdef ARL_HANDLE_32
+	typedef uint32_t ArlHandle;
+	#define ARL_HANDLE_INDEX_BITS 20
+#else
+	/**
+	 * @brief Generation-tagged handle (0 is the null handle).
+	 */
+	typedef uint64_t ArlHandle;
+
+	/**
+	 * @def ARL_HANDLE_INDEX_BITS
+	 * @brief Bits of a handle used by the slot index; the rest hold the generation.
+	 */
+	#define ARL_HANDLE_INDEX_BITS 32
+#endif
+
+/**
+ * @def ARL_HANDLE_NULL
+ * @brief The null handle, never returned by arl_handle_alloc().
+ */
+#define ARL_HANDLE_NULL ((ArlHandle)0)
+
+#define ARL_HANDLE_INDEX_MASK ((((ArlHandle)1) << ARL_HANDLE_INDEX_BITS) - 1)
+#define ARL_HANDLE_GEN_MASK ((ArlHandle)(~(ArlHandle)0 >> ARL_HANDLE_INDEX_BITS))
+
+/**
+ * @struct ArlHandleSlot
+ * @brief Sparse index entry.
+ *
+ * Fields:
+ *   - dense:      Position of the object in the dense array (next free slot when free)
+ *   - generation: Generation of the slot, bumped on every free
+ */
+typedef struct {
+	uint32_t dense;
+	uint32_t generation;
+} ArlHandleSlot;
+
+/**
+ * @struct ArlHandlePool
+ * @brief Dense object array with a generational sparse index.
+ *
+ * Fields:
+ *   - items:    Dense array of live objects
+ *   - owners:   Slot of each dense object, to fix the index on swap-remove
+ *   - slots:    Sparse index, addressed by handles
+ *   - size:     Object size, rounded up to the arena alignment
+ *   - count:    Number of live objects (the first `count` items)
+ *   - capacity: Maximum number of live objects
+ *   - free:     First free slot (UINT32_MAX when none)
+ *   - used:     Number of slots ever handed out
+ *   - retired:  Number of slots whose generation is exhausted (never reused)
+ */
+typedef struct {
+	uint8_t *items;
+	uint32_t *owners;
+	ArlHandleSlot *slots;
+	size_t size;
+	uint32_t count;
+	uint32_t capacity;
+	uint32_t free;
+	uint32_t used;
+	uint32_t retired;
+} ArlHandlePool;
+
+/**
+ * @brief Creates a pool, carving its arrays from an arena.
+ *
+ * @param pool     Pointer to the pool to initialize
+ * @param armel    Arena providing the memory (the pool lives until it is reset or freed)
+ * @param size     Object size in bytes
+ * @param capacity Maximum number of live objects
+ * @return 1 on success, 0 if the arena could not provide the arrays (with ARL_SOFTFAIL)
+ */
+int arl_handle_pool_new (ArlHandlePool *pool, Armel *armel, size_t size, uint32_t capacity);
+
+/**
+ * @brief Allocates an object at the end of the dense array.
+ *
+ * @param pool Pointer to the pool
+ * @return Handle to the new (uninitialized) object, or ARL_HANDLE_NULL if the pool is full
+ *         or every remaining slot is retired
+ */
+static inline ArlHandle arl_handle_alloc (ArlHandlePool *pool) {
+	uint32_t index;
+
+	if (pool->count == pool->capacity) {
+		return ARL_HANDLE_NULL;
+	}
+
+	if (pool->free != UINT32_MAX) {
+		index = pool->free;
+		pool->free = pool->slots[index].dense;
+	} else if (pool->used == pool->capacity) {
+		// Every slot not live is retired
+		return ARL_HANDLE_NULL;
+	} else {
+		index = pool->used++;
+		pool->slots[index].generation = 1;
+	}
+
+	pool->slots[index].dense = pool->count;
+	pool->owners[pool->count] = index;
+	pool->count++;
+
+	return ((ArlHandle)pool->slots[index].generation << ARL_HANDLE_INDEX_BITS) | index;
+}
+
+/**
+ * @brief Frees an object, moving the last dense object into its place.
+ *
+ * Pointers to the moved object are invalidated; its handle stays valid.
+ *
+ * @param pool   Pointer to the pool
+ * @param handle Handle of the object
+ * @return 1 if the object was freed, 0 if the handle was stale or null
+ */
+static inline int arl_handle_free (ArlHandlePool *pool, ArlHandle handle) {
+	uint32_t index = (uint32_t)(handle & ARL_HANDLE_INDEX_MASK);
+	uint32_t generation = (uint32_t)(handle >> ARL_HANDLE_INDEX_BITS);
+
+	if (generation == 0 || index >= pool->used || pool->slots[index].generation != generation) {
+		return 0;
+	}
+
+	// Swap-remove: the last dense object fills the hole
+	uint32_t hole = pool->slots[index].dense;
+	uint32_t last = --pool->count;
+
+	if (hole != last) {
+		memcpy(pool->items + (size_t)hole * pool->size, pool->items + (size_t)last * pool->size, pool->size);
+		pool->owners[hole] = pool->owners[last];
+		pool->slots[pool->owners[hole]].dense = hole;
+	}
+
+	// Generation 0 is never handed out; a slot reaching it would wrap, so it retires
+	uint32_t next = (uint32_t)((generation + 1) & ARL_HANDLE_GEN_MASK);
+	pool->slots[index].generation = next;
+	if (next == 0) {
+		pool->retired++;
+		return 1;
+	}
+	pool->slots[index].dense = pool->free;
+	pool->free = index;
+	return 1;
+}
+
+/**
+ * @brief Returns the object named by a handle.
+ *
+ * @param pool   Pointer to the pool
+ * @param handle Handle of the object
+ * @return Pointer to the object (valid until the next free), or NULL if the handle is stale
+ */
+static inline void* arl_handle_get (const ArlHandlePool *pool, ArlHandle handle) {
+	uint32_t index = (uint32_t)(handle & ARL_HANDLE_INDEX_MASK);
+	uint32_t generation = (uint32_t)(handle >> ARL_HANDLE_INDEX_BITS);
+
+	if (generation == 0 || index >= pool->used || pool->slots[index].generation != generation) {
+		return NULL;
+	}
+	return pool->items + (size_t)pool->slots[index].dense * pool->size;
+}
+
+/**
+ * @brief Returns the dense array of live objects, for bulk iteration over `pool->count` items.
+ */
+static inline void* arl_handle_items (const ArlHandlePool *pool) {
+	return pool->items;
+}
+
+/**
+ * @brief Returns the handle of the i-th live object.
+ */
+static inline ArlHandle arl_handle_at (const ArlHandlePool *pool, uint32_t i) {
+	uint32_t index = pool->owners[i];
+	return ((ArlHandle)pool->slots[index].generation << ARL_HANDLE_INDEX_BITS) | index;
+}
+
+#endif
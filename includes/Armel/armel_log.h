@@ -0,0 +1,158 @@
+/**
+ * @file armel_log.h
+ * @brief Concurrent append-only log arena with reserve/commit publication.
+ *
+ * Producers on any thread reserve a record with a single atomic fetch-add on the
+ * log cursor (the arl_alloc() bump, made concurrent), write it, then commit it.
+ * Each record starts with a small header holding its size and commit flag.
+ *
+ * A single consumer scans records in log order without locks: it stops at the
+ * first record that is not committed yet, so records are always seen in the order
+ * they were reserved. Once everything reserved has been consumed, the log can be
+ * reset and its memory reused.
+ *
+ * Example:
+ * ```c
+ * ArlLog log;
+ * arl_log_new(&log, 16 * ARL_MB);
+ *
+ * // Any producer thread
+ * Event* e = arl_log_reserve(&log, sizeof(Event));
+ * if (e) { fill(e); arl_log_commit(e); }
+ *
+ * // Consumer thread
+ * size_t size;
+ * Event* next;
+ * while ((next = arl_log_next(&log, &size)) != NULL) {
+ *     handle(next);
+ *     arl_log_consume(&log);
+ * }
+ * arl_log_reset(&log); // succeeds once the log is drained
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_LOG_H
+#define ARMEL_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_LOG_COMMITTED
+ * @brief Header state of a record that is ready to be consumed.
+ */
+#define ARL_LOG_COMMITTED 1u
+
+/**
+ * @def ARL_LOG_END
+ * @brief Header state marking the unused space at the end of a full log.
+ */
+#define ARL_LOG_END 2u
+
+/**
+ * @struct ArlLogHeader
+ * @brief Header stored before each record.
+ *
+ * Fields:
+ *   - state: 0 while reserved, then ARL_LOG_COMMITTED (or ARL_LOG_END)
+ *   - size:  Size of the record's payload in bytes
+ */
+typedef struct {
+	_Atomic uint32_t state;
+	uint32_t size;
+} ArlLogHeader;
+
+/**
+ * @def ARL_LOG_HEADER
+ * @brief Space taken by the header (keeps payloads ARL_ALIGN-aligned).
+ */
+#define ARL_LOG_HEADER arl_align_up(sizeof(ArlLogHeader), ARL_ALIGN)
+
+/**
+ * @struct ArlLog
+ * @brief Multi-producer, single-consumer append-only log.
+ *
+ * Fields:
+ *   - buffer, capacity: Log memory, read-only after creation
+ *   - cursor: Next free byte, advanced by producers with fetch-add
+ *   - read:   Offset of the next record to consume (consumer only)
+ */
+typedef struct {
+	uint8_t *buffer;
+	size_t capacity;
+
+	_Alignas(ARL_CACHE_LINE) _Atomic size_t cursor;
+
+	_Alignas(ARL_CACHE_LINE) size_t read;
+} ArlLog;
+
+/**
+ * @brief Creates a log.
+ *
+ * @param log      Pointer to the log to initialize
+ * @param capacity Capacity in bytes
+ */
+void arl_log_new (ArlLog *log, size_t capacity);
+
+/**
+ * @brief Releases the memory of the log.
+ *
+ * @param log Pointer to the log
+ */
+void arl_log_free (ArlLog *log);
+
+/**
+ * @brief Reserves a record (any producer thread).
+ *
+ * @param log  Pointer to the log
+ * @param size Size of the record in bytes (less than 4 GB)
+ * @return Pointer to the record (ARL_ALIGN-aligned), or NULL if the log is full
+ */
+void* arl_log_reserve (ArlLog *log, size_t size);
+
+/**
+ * @brief Publishes a reserved record to the consumer.
+ *
+ * @param record Pointer returned by arl_log_reserve()
+ */
+static inline void arl_log_commit (void *record) {
+	ArlLogHeader *header = (ArlLogHeader*)((uint8_t*)record - ARL_LOG_HEADER);
+	atomic_store_explicit(&header->state, ARL_LOG_COMMITTED, memory_order_release);
+}
+
+/**
+ * @brief Returns the next committed record in log order (consumer only).
+ *
+ * @param log  Pointer to the log
+ * @param size Receives the size of the record (may be NULL)
+ * @return Pointer to the record, or NULL if the next record is not committed yet
+ *         or the end of the log was reached
+ */
+void* arl_log_next (ArlLog *log, size_t *size);
+
+/**
+ * @brief Marks the record returned by arl_log_next() as consumed (consumer only).
+ *
+ * @param log Pointer to the log
+ */
+void arl_log_consume (ArlLog *log);
+
+/**
+ * @brief Rewinds the log to its beginning if every reserved record was consumed.
+ *
+ * Called by the consumer. Fails while a producer still holds an uncommitted
+ * reservation, or when records are left to consume. On success, the used part of
+ * the log is cleared (O(used)), so stale payload bytes never read as a header in
+ * the next round.
+ *
+ * @param log Pointer to the log
+ * @return 1 if the log was reset, 0 otherwise
+ */
+int arl_log_reset (ArlLog *log);
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file armel_mirror.h
+ * @brief Virtual-memory "magic" ring buffer for byte streams.
+ *
+ * The ring's pages are mapped twice, back-to-back (see arl_sys_alloc_mirror):
+ * a span that runs past the end of the buffer continues in the mirror, which is
+ * the beginning of the same memory. Any span up to the ring size is therefore
+ * contiguous regardless of wrap-around, so parsers and memcpy() need no split
+ * reads or writes.
+ *
+ * One producer reserves space and commits the bytes it wrote; one consumer peeks
+ * at everything committed and consumes what it used. Indices are exchanged with
+ * acquire/release atomics, as in armel_ring.h.
+ *
+ * Example:
+ * ```c
+ * ArlMirror stream;
+ * arl_mirror_new(&stream, ARL_MB);
+ *
+ * // Producer
+ * char* dst = arl_mirror_reserve(&stream, len);
+ * memcpy(dst, bytes, len);
+ * arl_mirror_commit(&stream, len);
+ *
+ * // Consumer
+ * size_t avail;
+ * const char* src = arl_mirror_peek(&stream, &avail);
+ * size_t used = parse(src, avail);
+ * arl_mirror_consume(&stream, used);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_MIRROR_H
+#define ARMEL_MIRROR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <Armel/armel.h>
+
+/**
+ * @struct ArlMirror
+ * @brief SPSC byte ring mapped twice in virtual memory.
+ *
+ * Positions are free-running byte counters; the index in the buffer is `pos & mask`.
+ *
+ * Fields:
+ *   - buffer, capacity, mask: Shared, read-only after creation
+ *   - head:      End of the committed bytes (written by the producer)
+ *   - tail_seen: Producer's cached copy of tail
+ *   - tail:      Start of the unconsumed bytes (written by the consumer)
+ *   - head_seen: Consumer's cached copy of head
+ */
+typedef struct {
+	uint8_t *buffer;
+	size_t capacity;
+	size_t mask;
+
+	_Alignas(ARL_CACHE_LINE) _Atomic size_t head;
+	size_t tail_seen;
+
+	_Alignas(ARL_CACHE_LINE) _Atomic size_t tail;
+	size_t head_seen;
+} ArlMirror;
+
+/**
+ * @brief Creates a mirrored ring.
+ *
+ * @param ring     Pointer to the ring to initialize
+ * @param capacity Capacity in bytes, rounded up to a power of 2 and to the page granularity
+ * @return 1 on success, 0 if the mapping was refused (memory budget or system): the ring is left empty
+ */
+int arl_mirror_new (ArlMirror *ring, size_t capacity);
+
+/**
+ * @brief Unmaps the ring.
+ *
+ * @param ring Pointer to the ring
+ */
+void arl_mirror_free (ArlMirror *ring);
+
+/**
+ * @brief Returns `size` contiguous writable bytes at the head (producer side).
+ *
+ * @param ring Pointer to the ring
+ * @param size Number of bytes to reserve (at most the capacity)
+ * @return Pointer to the reserved bytes, or NULL if there is not enough free space
+ */
+static inline void* arl_mirror_reserve (ArlMirror *ring, size_t size) {
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	if (head + size - ring->tail_seen > ring->capacity) {
+		ring->tail_seen = atomic_load_explicit(&ring->tail, memory_order_acquire);
+		if (head + size - ring->tail_seen > ring->capacity) {
+			return NULL;
+		}
+	}
+	return ring->buffer + (head & ring->mask);
+}
+
+/**
+ * @brief Publishes `size` bytes written at the head (producer side).
+ *
+ * @param ring Pointer to the ring
+ * @param size Number of bytes written, at most the last reserved size
+ */
+static inline void arl_mirror_commit (ArlMirror *ring, size_t size) {
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	atomic_store_explicit(&ring->head, head + size, memory_order_release);
+}
+
+/**
+ * @brief Returns all committed bytes as one contiguous span (consumer side).
+ *
+ * @param ring Pointer to the ring
+ * @param size Receives the number of readable bytes
+ * @return Pointer to the first readable byte, or NULL if the ring is empty
+ */
+static inline void* arl_mirror_peek (ArlMirror *ring, size_t *size) {
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	if (tail == ring->head_seen) {
+		ring->head_seen = atomic_load_explicit(&ring->head, memory_order_acquire);
+		if (tail == ring->head_seen) {
+			*size = 0;
+			return NULL;
+		}
+	}
+
+	*size = ring->head_seen - tail;
+	return ring->buffer + (tail & ring->mask);
+}
+
+/**
+ * @brief Releases `size` bytes at the tail (consumer side).
+ *
+ * @param ring Pointer to the ring
+ * @param size Number of bytes consumed, at most the size returned by arl_mirror_peek()
+ */
+static inline void arl_mirror_consume (ArlMirror *ring, size_t size) {
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	atomic_store_explicit(&ring->tail, tail + size, memory_order_release);
+}
+
+#endif
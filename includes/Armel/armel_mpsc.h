@@ -0,0 +1,211 @@
+/**
+ * @file armel_mpsc.h
+ * @brief Arena-backed multi-producer / single-consumer message queue.
+ *
+ * Each producer allocates its messages (queue node and payload together) from its
+ * own arenas, and links them into an intrusive lock-free MPSC queue. The consumer
+ * acknowledges messages in batches; once every message of one of its arenas has
+ * been acknowledged, the producer resets that arena. Nothing is freed per message,
+ * and no memory crosses back to the producer through the allocator.
+ *
+ * Each producer alternates between two arenas so that it can keep sending while
+ * the consumer drains the messages of the other one.
+ *
+ * Example:
+ * ```c
+ * ArlMpsc queue;
+ * arl_mpsc_new(&queue);
+ *
+ * // Producer thread
+ * ArlMpscProducer me;
+ * arl_mpsc_producer_new(&queue, &me, 64 * ARL_KB);
+ * Msg* m = arl_mpsc_alloc(&me, sizeof(Msg));
+ * fill(m);
+ * arl_mpsc_send(&queue, m);
+ *
+ * // Consumer thread
+ * Msg* in;
+ * while ((in = arl_mpsc_pop(&queue, NULL)) != NULL) {
+ *     handle(in);
+ *     arl_mpsc_done(&queue, in);
+ * }
+ * arl_mpsc_flush(&queue);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_MPSC_H
+#define ARMEL_MPSC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_MPSC_MAX_PRODUCERS
+ * @brief Maximum number of live producers per queue (freed producers' slots are reused).
+ */
+#ifndef ARL_MPSC_MAX_PRODUCERS
+	#define ARL_MPSC_MAX_PRODUCERS 64
+#endif
+
+/**
+ * @def ARL_MPSC_BATCH
+ * @brief Number of acknowledgements the consumer accumulates before publishing them.
+ */
+#ifndef ARL_MPSC_BATCH
+	#define ARL_MPSC_BATCH 64
+#endif
+
+/**
+ * @def ARL_MPSC_SWITCH
+ * @brief Number of messages a producer sends from one arena before trying the other.
+ */
+#ifndef ARL_MPSC_SWITCH
+	#define ARL_MPSC_SWITCH 256
+#endif
+
+typedef struct ArlMpscProducer ArlMpscProducer;
+
+/**
+ * @struct ArlMpscNode
+ * @brief Intrusive queue node stored right before each payload.
+ */
+typedef struct ArlMpscNode {
+	_Atomic(struct ArlMpscNode*) next;
+	ArlMpscProducer *producer;
+	uint32_t half;
+	uint32_t size;
+} ArlMpscNode;
+
+/**
+ * @def ARL_MPSC_NODE
+ * @brief Space taken by the node (keeps payloads ARL_ALIGN-aligned).
+ */
+#define ARL_MPSC_NODE arl_align_up(sizeof(ArlMpscNode), ARL_ALIGN)
+
+/**
+ * @struct ArlMpscProducer
+ * @brief Per-producer state: two arenas and their message counters.
+ *
+ * Fields:
+ *   - arenas:  Arenas holding this producer's messages
+ *   - sent:    Messages sent from each arena (producer only)
+ *   - current: Arena receiving new messages (producer only)
+ *   - acked:   Messages acknowledged per arena (written by the consumer)
+ *   - pending: Acknowledgements not yet published (consumer only)
+ *   - slot:    Index in the queue's producer table
+ */
+struct ArlMpscProducer {
+	Armel arenas[2];
+	size_t sent[2];
+	uint32_t current;
+	size_t slot;
+
+	_Alignas(ARL_CACHE_LINE) _Atomic size_t acked[2];
+	size_t pending[2];
+};
+
+/**
+ * @struct ArlMpsc
+ * @brief Intrusive MPSC queue (Vyukov) of arena-allocated messages.
+ *
+ * Fields:
+ *   - head:      Last pushed node, exchanged by producers
+ *   - tail:      Next node to pop (consumer only)
+ *   - stub:      Placeholder node keeping the queue non-empty
+ *   - producers: Registered producers, used by arl_mpsc_flush()
+ *   - count:     Highest producer slot ever used, plus one
+ *   - flushing:  Odd while arl_mpsc_flush() walks the producers
+ */
+typedef struct {
+	_Alignas(ARL_CACHE_LINE) _Atomic(ArlMpscNode*) head;
+	_Alignas(ARL_CACHE_LINE) ArlMpscNode *tail;
+	ArlMpscNode stub;
+	_Atomic(ArlMpscProducer*) producers[ARL_MPSC_MAX_PRODUCERS];
+	_Atomic size_t count;
+	_Atomic size_t flushing;
+} ArlMpsc;
+
+/**
+ * @brief Initializes an empty queue.
+ *
+ * @param queue Pointer to the queue
+ */
+void arl_mpsc_new (ArlMpsc *queue);
+
+/**
+ * @brief Creates a producer and registers it with the queue.
+ *
+ * The producer's arenas chain new blocks when a burst outgrows them. Takes the
+ * first slot not held by a live producer.
+ *
+ * @param queue    Pointer to the queue
+ * @param producer Producer to initialize (owned by the calling thread)
+ * @param size     Initial size of each of the producer's two arenas
+ */
+void arl_mpsc_producer_new (ArlMpsc *queue, ArlMpscProducer *producer, size_t size);
+
+/**
+ * @brief Unregisters a producer and releases its arenas (producer thread).
+ *
+ * All of its messages must have been popped and acknowledged. Waits for a
+ * concurrent arl_mpsc_flush() that may still see the producer to finish.
+ *
+ * @param queue    Pointer to the queue the producer is registered with
+ * @param producer Pointer to the producer
+ */
+void arl_mpsc_producer_free (ArlMpsc *queue, ArlMpscProducer *producer);
+
+/**
+ * @brief Allocates a message payload from the producer's arenas (producer thread).
+ *
+ * Recycles an arena first when every message allocated from it was acknowledged.
+ *
+ * @param producer Pointer to the producer
+ * @param size     Size of the payload in bytes (at most UINT32_MAX)
+ * @return Pointer to the payload
+ */
+void* arl_mpsc_alloc (ArlMpscProducer *producer, size_t size);
+
+/**
+ * @brief Pushes a payload allocated with arl_mpsc_alloc() (producer thread).
+ *
+ * @param queue   Pointer to the queue
+ * @param payload Payload to send
+ */
+void arl_mpsc_send (ArlMpsc *queue, void *payload);
+
+/**
+ * @brief Pops the oldest message (consumer thread).
+ *
+ * @param queue Pointer to the queue
+ * @param size  Receives the size of the payload (may be NULL)
+ * @return The payload, or NULL if the queue is empty (or a push is in progress)
+ */
+void* arl_mpsc_pop (ArlMpsc *queue, size_t *size);
+
+/**
+ * @brief Acknowledges a consumed message (consumer thread).
+ *
+ * Acknowledgements are published to the producer in batches of ARL_MPSC_BATCH.
+ * The payload must not be used afterwards.
+ *
+ * @param queue   Pointer to the queue
+ * @param payload Payload returned by arl_mpsc_pop()
+ */
+void arl_mpsc_done (ArlMpsc *queue, void *payload);
+
+/**
+ * @brief Publishes all pending acknowledgements (consumer thread).
+ *
+ * Call it when the consumer goes idle so producers can recycle their arenas.
+ *
+ * @param queue Pointer to the queue
+ */
+void arl_mpsc_flush (ArlMpsc *queue);
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * @file armel_output.h
+ * @brief Zero-copy output of arena buffers with writev(), and vmsplice() on Linux.
+ *
+ * A response built in an arena is usually several allocations: headers, body
+ * chunks, trailers. Instead of copying them into one send buffer, queue them in
+ * an ArlOutput and hand the list to the kernel:
+ *   - arl_output_write() gathers them with writev(); once it returns, the kernel
+ *     has its own copy and the arena can be reset.
+ *   - arl_output_splice() (Linux) moves the pages into a pipe with vmsplice(),
+ *     without copying. The pipe then references arena memory: the arena is pinned
+ *     until the kernel is done with the pages, and resetting, rewinding or freeing
+ *     it while the pipe still holds data is a fatal error (checked even with
+ *     ARL_NO_CHECKS). Meant for large, page-aligned buffers that nothing else
+ *     shares pages with.
+ *
+ * When the pipe is consumed with read(), an empty pipe means the pages are free:
+ * arl_output_drained() unpins the arena. When it is splice()d onward (to a socket),
+ * the page references move to the socket's send queue and an empty pipe proves
+ * nothing: call arl_output_release() once the data is known to be gone (the peer
+ * acknowledged it, or SIOCOUTQ reports an empty send queue).
+ *
+ * Not available on Windows.
+ *
+ * Example:
+ * ```c
+ * ArlOutput out;
+ * arl_output_init(&out);
+ * arl_output_add(&out, header, header_len);
+ * arl_output_add(&out, body, body_len);
+ * arl_output_write(&out, socket_fd);
+ * arl_reset(&arena);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_OUTPUT_H
+#define ARMEL_OUTPUT_H
+
+#ifndef _WIN32
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_OUTPUT_IOV
+ * @brief Maximum number of buffers queued in one ArlOutput.
+ */
+#ifndef ARL_OUTPUT_IOV
+	#define ARL_OUTPUT_IOV 64
+#endif
+
+/**
+ * @struct ArlOutputPin
+ * @brief Arena finalizer state keeping spliced pages alive (see arl_output_splice).
+ *
+ * Fields:
+ *   - pipe:   Pipe the pages were moved into
+ *   - active: 0 once unpinned
+ *   - owner:  Link pointing at this pin (the output's list head or the previous pin)
+ *   - next:   Older pin of the same output
+ */
+typedef struct ArlOutputPin {
+	int pipe;
+	int active;
+	struct ArlOutputPin **owner;
+	struct ArlOutputPin *next;
+} ArlOutputPin;
+
+/**
+ * @struct ArlOutput
+ * @brief Buffers waiting to be written.
+ *
+ * Fields:
+ *   - iov:   Queued buffers (advanced in place by partial writes)
+ *   - count: Number of queued buffers
+ *   - first: First buffer not completely written
+ *   - bytes: Bytes not written yet
+ *   - pin:   Pins held by splices, most recent first (NULL when none)
+ */
+typedef struct {
+	struct iovec iov[ARL_OUTPUT_IOV];
+	int count;
+	int first;
+	size_t bytes;
+	ArlOutputPin *pin;
+} ArlOutput;
+
+/**
+ * @brief Initializes an empty output.
+ */
+void arl_output_init (ArlOutput *out);
+
+/**
+ * @brief Queues a buffer. Consecutive buffers that touch are merged.
+ *
+ * @param out Pointer to the output
+ * @param ptr Start of the buffer (must stay valid until written)
+ * @param len Length in bytes
+ * @return 1 if queued, 0 if the output already holds ARL_OUTPUT_IOV buffers
+ */
+int arl_output_add (ArlOutput *out, const void *ptr, size_t len);
+
+/**
+ * @brief Writes the queued buffers with writev(), resuming after partial writes.
+ *
+ * On a non-blocking descriptor, returns early with errno set to EAGAIN; call
+ * again to continue where it stopped.
+ *
+ * @param out Pointer to the output
+ * @param fd  Destination (socket, pipe, file)
+ * @return Bytes written by this call, or -1 if an error happened before any byte (errno set)
+ */
+ssize_t arl_output_write (ArlOutput *out, int fd);
+
+/**
+ * @brief Moves the queued buffers into a pipe with vmsplice(), without copying (Linux).
+ *
+ * Pins `armel` until arl_output_drained() or arl_output_release() unpins it.
+ * Every call that moves data registers its own finalizer in `armel`, after the
+ * buffers being spliced, so splicing from several arenas or into several pipes
+ * keeps each of them checked, and a rewind that frees the buffers runs the check.
+ * Blocks while the pipe is full. The output must not be moved while pinned: the
+ * arena's finalizers clear its pins on reset.
+ *
+ * @param out   Pointer to the output
+ * @param armel Arena holding the queued buffers (allocated before this call)
+ * @param pipe  Write end of a pipe
+ * @return Bytes moved, or -1 (errno set; ENOSYS on other systems)
+ */
+ssize_t arl_output_splice (ArlOutput *out, Armel *armel, int pipe);
+
+/**
+ * @brief Unpins the arena once the pipe is empty.
+ *
+ * Only meaningful when the pipe is consumed with read(): data splice()d out of
+ * the pipe may still reference the pages (see arl_output_release).
+ *
+ * @param out Pointer to the output
+ * @return 1 if nothing is pinned any more, 0 while a pipe still holds data
+ */
+int arl_output_drained (ArlOutput *out);
+
+/**
+ * @brief Unpins every arena unconditionally: the caller knows the kernel is done with the pages.
+ *
+ * For pipes splice()d onward to a socket, call it once the receiver acknowledged
+ * the data or the socket's send queue is empty (SIOCOUTQ).
+ *
+ * @param out Pointer to the output
+ */
+void arl_output_release (ArlOutput *out);
+
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+/**
+ * @file armel_pool.h
+ * @brief Fixed-size object pool over an arena, with lock-free frees from other threads.
+ *
+ * A pool carves equally sized slots from an arena and recycles freed slots
+ * through an intrusive free list. The owner thread allocates and frees without
+ * atomics.
+ *
+ * Other threads never touch that list: they push freed slots onto the pool's
+ * remote inbox (a lock-free stack) with a single compare-and-swap. The owner
+ * takes the whole inbox with one atomic exchange the next time its free list is
+ * empty, before carving new slots from the arena.
+ *
+ * Example:
+ * ```c
+ * Armel armel;
+ * ArlPool pool;
+ * arl_new(&armel, ARL_MB);
+ * arl_pool_new(&pool, &armel, sizeof(Message));
+ *
+ * // Owner thread
+ * Message* m = arl_pool_alloc(&pool);
+ *
+ * // Any other thread, once done with m
+ * arl_pool_free_remote(&pool, m);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_POOL_H
+#define ARMEL_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <Armel/armel.h>
+
+/**
+ * @struct ArlPoolSlot
+ * @brief Link stored in a free slot.
+ */
+typedef struct ArlPoolSlot {
+	struct ArlPoolSlot *next;
+} ArlPoolSlot;
+
+/**
+ * @struct ArlPool
+ * @brief Fixed-size object pool owned by one thread.
+ *
+ * Fields:
+ *   - armel:  Arena the slots are carved from
+ *   - size:   Slot size, rounded up to the arena alignment
+ *   - free:   Free slots (owner only)
+ *   - remote: Slots freed by other threads, waiting for the owner
+ */
+typedef struct {
+	Armel *armel;
+	size_t size;
+	ArlPoolSlot *free;
+
+	_Alignas(ARL_CACHE_LINE) _Atomic(ArlPoolSlot*) remote;
+} ArlPool;
+
+/**
+ * @brief Creates a pool of `size`-byte objects.
+ *
+ * @param pool  Pointer to the pool to initialize
+ * @param armel Arena the slots are carved from (owned by the same thread)
+ * @param size  Object size in bytes
+ */
+void arl_pool_new (ArlPool *pool, Armel *armel, size_t size);
+
+/**
+ * @brief Refills the free list from the remote inbox, or carves a new slot.
+ *
+ * Called by arl_pool_alloc() when the free list is empty.
+ *
+ * @param pool Pointer to the pool
+ * @return Pointer to a slot, or NULL if the arena is full (with ARL_SOFTFAIL)
+ */
+void* arl_pool_refill (ArlPool *pool);
+
+/**
+ * @brief Allocates an object (owner thread).
+ *
+ * @param pool Pointer to the pool
+ * @return Pointer to an uninitialized object, or NULL if the arena is full (with ARL_SOFTFAIL)
+ */
+static inline void* arl_pool_alloc (ArlPool *pool) {
+	ArlPoolSlot *slot = pool->free;
+
+	if (slot == NULL) {
+		return arl_pool_refill(pool);
+	}
+	pool->free = slot->next;
+	return slot;
+}
+
+/**
+ * @brief Frees an object (owner thread).
+ *
+ * @param pool Pointer to the pool
+ * @param ptr  Object returned by arl_pool_alloc()
+ */
+static inline void arl_pool_free (ArlPool *pool, void *ptr) {
+	ArlPoolSlot *slot = (ArlPoolSlot*)ptr;
+
+	slot->next = pool->free;
+	pool->free = slot;
+}
+
+/**
+ * @brief Frees an object from any thread other than the owner.
+ *
+ * @param pool Pointer to the pool
+ * @param ptr  Object returned by arl_pool_alloc()
+ */
+void arl_pool_free_remote (ArlPool *pool, void *ptr);
+
+/**
+ * @brief Forgets every free slot, after the arena was reset (owner thread).
+ *
+ * @param pool Pointer to the pool
+ *
+ * @note Objects still held by other threads must not be freed afterwards.
+ */
+void arl_pool_reset (ArlPool *pool);
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file armel_prefault.h
+ * @brief Parallel prefault and zero-fill of large arenas at startup.
+ *
+ * Faulting in a 64 GB arena page by page (ARL_ZEROS, or the first pass over a
+ * fresh mapping) takes seconds on one thread: most of it is the kernel clearing
+ * and mapping pages, which scales with the number of threads doing it. These
+ * functions split the range into one disjoint, page-aligned slice per thread,
+ * run short-lived threads over the slices and join them.
+ *
+ * With a NUMA node, each thread is first pinned to that node's CPUs (Linux):
+ * first-touch placement then puts the pages on that node.
+ *
+ * Ranges smaller than ARL_PREFAULT_SLICE per thread use fewer threads, so small
+ * arenas do not pay for thread creation.
+ *
+ * Example:
+ * ```c
+ * Armel arena;
+ * arl_new_prefault(&arena, 64 * ARL_GB, 64, ARL_ZEROS, 16, ARL_NUMA_ANY);
+ *
+ * // Re-zero the used part of a recycled arena, on node 1
+ * arl_prefault(arena.base, arl_used(&arena), ARL_PREFAULT_ZERO, 16, 1);
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_PREFAULT_H
+#define ARMEL_PREFAULT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_PREFAULT_THREADS
+ * @brief Maximum number of threads per call.
+ */
+#ifndef ARL_PREFAULT_THREADS
+	#define ARL_PREFAULT_THREADS 64
+#endif
+
+/**
+ * @def ARL_PREFAULT_SLICE
+ * @brief Minimum bytes per thread (16 MB).
+ */
+#ifndef ARL_PREFAULT_SLICE
+	#define ARL_PREFAULT_SLICE (16 * ARL_MB)
+#endif
+
+/**
+ * @def ARL_NUMA_ANY
+ * @brief No NUMA pinning: threads run wherever the scheduler puts them.
+ */
+#define ARL_NUMA_ANY (-1)
+
+/**
+ * @enum ArlPrefaultMode
+ * @brief What each thread does to its slice.
+ *
+ *   - ARL_PREFAULT_TOUCH: commits every page, keeping its content (a fresh mapping stays zeroed)
+ *   - ARL_PREFAULT_ZERO:  zero-fills the slice (memset)
+ */
+typedef enum {
+	ARL_PREFAULT_TOUCH,
+	ARL_PREFAULT_ZERO
+} ArlPrefaultMode;
+
+/**
+ * @brief Prefaults or zero-fills a memory range with several threads.
+ *
+ * @param ptr     Start of the range
+ * @param size    Size of the range in bytes
+ * @param mode    ARL_PREFAULT_TOUCH or ARL_PREFAULT_ZERO
+ * @param threads Number of threads, or 0 for one per online CPU
+ * @param node    NUMA node to pin the threads to, or ARL_NUMA_ANY
+ * @return Number of threads used (the calling thread does the work when none can be created)
+ */
+int arl_prefault (void *ptr, size_t size, ArlPrefaultMode mode, int threads, int node);
+
+/**
+ * @brief Creates an arena (see arl_new_custom) and prefaults it with several threads.
+ *
+ * A fresh mapping is already zeroed: with ARL_ZEROS, pages are only touched,
+ * instead of the single-threaded memset of arl_new_custom.
+ *
+ * @param armel     Pointer to an arena to initialise
+ * @param size      Capacity of the arena in bytes
+ * @param alignment Alignment, a power of 2
+ * @param flags     Arena flags (ARL_ZEROS, ARL_SOFTFAIL)
+ * @param threads   Number of threads, or 0 for one per online CPU
+ * @param node      NUMA node to place the pages on, or ARL_NUMA_ANY
+ */
+void arl_new_prefault (Armel *armel, size_t size, size_t alignment, uint8_t flags, int threads, int node);
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * @file armel_profile.h
+ * @brief Arena profiles: size new arenas from the peak usage of previous ones.
+ *
+ * A profile is a named sizing history. Arenas created through a profile report
+ * their high-water mark on every reset and free, and the profile folds it into a
+ * decaying percentile estimate. The next arena created with the same profile is
+ * sized from that estimate, so per-request arenas converge to the right size.
+ *
+ * Profile arenas chain blocks when they outgrow their estimate (see
+ * arl_overflow_grow), and the overflow shows up in the next peak.
+ *
+ * Estimates can be saved to a text file and loaded at the next start.
+ *
+ * Example:
+ * ```c
+ * static ArlProfileSet profiles;
+ * arl_profile_load(&profiles, "armel.profiles");
+ *
+ * ArlProfile* request = arl_profile_get(&profiles, "request", 64 * ARL_KB);
+ *
+ * Armel armel;
+ * arl_profile_new(request, &armel);
+ * handle_request(&armel);
+ * arl_free(&armel);               // reports the peak to the profile
+ *
+ * arl_profile_save(&profiles, "armel.profiles");
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_PROFILE_H
+#define ARMEL_PROFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_PROFILE_MAX
+ * @brief Maximum number of profiles in a set.
+ */
+#ifndef ARL_PROFILE_MAX
+	#define ARL_PROFILE_MAX 64
+#endif
+
+/**
+ * @def ARL_PROFILE_NAME
+ * @brief Maximum length of a profile name, terminator included.
+ */
+#ifndef ARL_PROFILE_NAME
+	#define ARL_PROFILE_NAME 32
+#endif
+
+/**
+ * @def ARL_PROFILE_PERCENTILE
+ * @brief Default fraction of arenas expected to fit without chaining a block.
+ */
+#ifndef ARL_PROFILE_PERCENTILE
+	#define ARL_PROFILE_PERCENTILE 0.95
+#endif
+
+/**
+ * @def ARL_PROFILE_RATE
+ * @brief Step of the estimate, relative to its value: larger adapts faster, smaller is steadier.
+ */
+#ifndef ARL_PROFILE_RATE
+	#define ARL_PROFILE_RATE 0.1
+#endif
+
+/**
+ * @struct ArlProfile
+ * @brief Sizing history of one kind of arena.
+ *
+ * Fields:
+ *   - name:       Key of the profile
+ *   - initial:    Size used until the first peak is reported
+ *   - percentile: Target percentile of the peaks (ARL_PROFILE_PERCENTILE by default)
+ *   - estimate:   Current estimate of that percentile, in bytes
+ *   - samples:    Number of peaks reported
+ *   - lock:       Guards updates from arenas on different threads
+ */
+typedef struct {
+	char name[ARL_PROFILE_NAME];
+	size_t initial;
+	double percentile;
+	double estimate;
+	uint64_t samples;
+	atomic_flag lock;
+} ArlProfile;
+
+/**
+ * @struct ArlProfileSet
+ * @brief Profiles keyed by name.
+ */
+typedef struct {
+	ArlProfile profiles[ARL_PROFILE_MAX];
+	size_t count;
+	atomic_flag lock;
+} ArlProfileSet;
+
+/**
+ * @brief Finds a profile by name, creating it if needed.
+ *
+ * A zero-initialized set is ready to use.
+ *
+ * @param set     Pointer to the set
+ * @param name    Profile name (truncated to ARL_PROFILE_NAME - 1 characters, no whitespace)
+ * @param initial Size of the first arenas, before any peak is known
+ * @return Pointer to the profile (stable for the life of the set), or NULL if the set is full
+ */
+ArlProfile* arl_profile_get (ArlProfileSet *set, const char *name, size_t initial);
+
+/**
+ * @brief Returns the size the next arena of this profile will get.
+ *
+ * @param profile Pointer to the profile
+ * @return Estimate rounded up to 4 KB, or the initial size without history
+ */
+size_t arl_profile_size (ArlProfile *profile);
+
+/**
+ * @brief Creates an arena sized by the profile and reporting its peaks to it.
+ *
+ * @param profile Pointer to the profile (must outlive the arena)
+ * @param armel   Pointer to the arena to initialize
+ */
+void arl_profile_new (ArlProfile *profile, Armel *armel);
+
+/**
+ * @brief Folds a peak into the profile's estimate (called on reset and free).
+ *
+ * Usable directly as an ArlPeakFn with the profile as context.
+ *
+ * @param armel Arena reporting its peak (unused)
+ * @param peak  Peak usage in bytes
+ * @param ctx   Pointer to the ArlProfile
+ */
+void arl_profile_observe (Armel *armel, size_t peak, void *ctx);
+
+/**
+ * @brief Writes the estimates to a text file, one profile per line.
+ *
+ * @param set  Pointer to the set
+ * @param path File to write
+ * @return 1 on success, 0 if the file could not be written
+ */
+int arl_profile_save (ArlProfileSet *set, const char *path);
+
+/**
+ * @brief Loads estimates written by arl_profile_save().
+ *
+ * Profiles are created or updated; their initial size is kept when they already exist.
+ *
+ * @param set  Pointer to the set
+ * @param path File to read
+ * @return 1 on success, 0 if the file could not be read
+ */
+int arl_profile_load (ArlProfileSet *set, const char *path);
+
+#endif
@@ -0,0 +1,163 @@
+/**
+ * @file armel_ref.h
+ * @brief 32-bit compressed references into an arena.
+ *
+ * A reference is the offset of an object from the arena's base, divided by the
+ * arena alignment, plus one (0 is the null reference). Pointer-heavy structures
+ * stored in an arena can keep 4-byte references instead of 8-byte pointers:
+ * nodes shrink and more of them fit in cache.
+ *
+ * One arena can address 2^32 * alignment bytes: 64 GB with 16-byte alignment,
+ * 16 GB with 4-byte alignment.
+ *
+ * References are relative to the arena's first block, which never moves: they
+ * stay valid when a growable arena chains blocks, but memory from the chained
+ * blocks cannot be referenced. Do not keep them across arl_free().
+ *
+ * Example:
+ * ```c
+ * typedef struct { int key; arl_ref32 left, right; } Node;
+ *
+ * arl_ref32 root = arl_alloc_ref(&armel, sizeof(Node));
+ * Node* node = ARL_DEREF(&armel, Node, root);
+ * node->left = ARL_REF_NULL;
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_REF_H
+#define ARMEL_REF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Armel/armel.h>
+
+/**
+ * @brief Compressed reference to an object in an arena (0 is null).
+ */
+typedef uint32_t arl_ref32;
+
+/**
+ * @def ARL_REF_NULL
+ * @brief The null reference.
+ */
+#define ARL_REF_NULL ((arl_ref32)0)
+
+/**
+ * @brief Returns log2 of the arena alignment, the scale of its references.
+ */
+static inline unsigned arl_ref_shift (const Armel *armel) {
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_ctzll((unsigned long long)armel->alignment);
+#else
+	unsigned shift = 0;
+	while (((size_t)1 << shift) < armel->alignment) {
+		shift++;
+	}
+	return shift;
+#endif
+}
+
+/**
+ * @brief Encodes a pointer into the arena's first block as a reference.
+ *
+ * @param armel Pointer to the arena
+ * @param ptr   Aligned pointer into the arena, or NULL
+ * @return Reference to `ptr` (ARL_REF_NULL for NULL)
+ */
+static inline arl_ref32 arl_ref_encode (const Armel *armel, const void *ptr) {
+	if (ptr == NULL) {
+		return ARL_REF_NULL;
+	}
+
+	uintptr_t offset = (uintptr_t)ptr - (uintptr_t)armel->root;
+	uintptr_t index  = (offset >> arl_ref_shift(armel)) + 1;
+
+	ARL_CHECK((uintptr_t)ptr >= (uintptr_t)armel->root && (uintptr_t)ptr < (uintptr_t)armel->root_end,
+		"arl_ref_encode: pointer outside the arena's first block");
+	ARL_CHECK((offset & armel->mask) == 0, "arl_ref_encode: pointer not aligned");
+	ARL_CHECK(index <= UINT32_MAX, "arl_ref_encode: offset beyond the 32-bit range");
+
+	return (arl_ref32)index;
+}
+
+/**
+ * @brief Decodes a reference into a pointer.
+ *
+ * @param armel Pointer to the arena the reference was encoded with
+ * @param ref   Reference
+ * @return Pointer to the object, or NULL for ARL_REF_NULL
+ */
+static inline void* arl_ref_decode (const Armel *armel, arl_ref32 ref) {
+	if (ref == ARL_REF_NULL) {
+		return NULL;
+	}
+
+	uint8_t *ptr = (uint8_t*)armel->root + ((uintptr_t)(ref - 1) << arl_ref_shift(armel));
+	ARL_CHECK(ptr < (uint8_t*)armel->root_end, "arl_ref_decode: reference outside the arena's first block");
+	return ptr;
+}
+
+/**
+ * @brief Decodes a reference to an object of `size` bytes, checking that all of it is in the block.
+ *
+ * @param armel Pointer to the arena the reference was encoded with
+ * @param ref   Reference
+ * @param size  Size of the object
+ * @return Pointer to the object, or NULL for ARL_REF_NULL
+ */
+static inline void* arl_ref_decode_sized (const Armel *armel, arl_ref32 ref, size_t size) {
+	uint8_t *ptr = (uint8_t*)arl_ref_decode(armel, ref);
+
+	ARL_CHECK(ptr == NULL || size <= (size_t)((uint8_t*)armel->root_end - ptr),
+		"arl_ref_decode: object runs past the arena's first block");
+	return ptr;
+}
+
+/**
+ * @brief Encodes a typed pointer.
+ *
+ * Example:
+ *     node->left = ARL_REF(&armel, child);
+ */
+#define ARL_REF(A, PTR) arl_ref_encode((A), (PTR))
+
+/**
+ * @brief Decodes a reference as a pointer to T.
+ *
+ * Example:
+ *     Node* left = ARL_DEREF(&armel, Node, node->left);
+ */
+#define ARL_DEREF(A, T, REF) ((T*)arl_ref_decode((A), (REF)))
+
+/**
+ * @brief Decodes a reference as a pointer to T, checking that the whole T is in the block.
+ *
+ * Example:
+ *     Node* left = ARL_DEREF_CHECKED(&armel, Node, node->left);
+ */
+#define ARL_DEREF_CHECKED(A, T, REF) ((T*)arl_ref_decode_sized((A), (REF), sizeof(T)))
+
+/**
+ * @brief Allocates memory and returns it as a reference.
+ *
+ * @param armel Pointer to the arena
+ * @param size  Number of bytes to allocate
+ * @return Reference to the memory, or ARL_REF_NULL if the allocation failed or
+ *         landed outside the first block (chained or out-of-line memory)
+ */
+static inline arl_ref32 arl_alloc_ref (Armel *armel, size_t size) {
+	uint8_t *ptr = (uint8_t*)arl_alloc(armel, size);
+
+	if (ptr == NULL || ptr < (uint8_t*)armel->root || ptr + size > (uint8_t*)armel->root_end) {
+		return ARL_REF_NULL;
+	}
+	if ((((uintptr_t)(ptr - (uint8_t*)armel->root)) >> arl_ref_shift(armel)) >= UINT32_MAX) {
+		return ARL_REF_NULL;
+	}
+	return arl_ref_encode(armel, ptr);
+}
+
+#endif
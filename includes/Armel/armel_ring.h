@@ -0,0 +1,196 @@
+/**
+ * @file armel_ring.h
+ * @brief Single-producer / single-consumer ring-buffer arena with FIFO release.
+ *
+ * A plain arena can only reclaim memory once everything allocated in it is done.
+ * In a streaming pipeline, records are allocated in order by one thread and
+ * released in the same order by another: the ring arena reclaims them as they go.
+ *
+ * The producer bump-allocates variable-size records at the head and publishes them
+ * with arl_ring_commit(). The consumer reads them at the tail and releases them with
+ * arl_ring_release(). When a record does not fit before the end of the buffer, the
+ * remaining tail space is skipped and the record starts again at the beginning,
+ * so every record is contiguous.
+ *
+ * Head and tail indices live on separate cache lines and are exchanged with
+ * acquire/release atomics; each side caches the other's index to avoid touching
+ * the shared line on every call.
+ *
+ * Example:
+ * ```c
+ * ArlRing ring;
+ * arl_ring_new(&ring, ARL_MB);
+ *
+ * // Producer thread
+ * Packet* p = arl_ring_alloc(&ring, sizeof(Packet));
+ * fill(p);
+ * arl_ring_commit(&ring);
+ *
+ * // Consumer thread
+ * size_t size;
+ * Packet* q = arl_ring_peek(&ring, &size);
+ * if (q) { process(q); arl_ring_release(&ring); }
+ * ```
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_RING_H
+#define ARMEL_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <Armel/armel.h>
+
+/**
+ * @def ARL_RING_HEADER
+ * @brief Size of the header stored before each record (keeps payloads ARL_ALIGN-aligned).
+ */
+#define ARL_RING_HEADER arl_align_up(sizeof(size_t), ARL_ALIGN)
+
+/**
+ * @def ARL_RING_SKIP
+ * @brief Header value marking the unused space left before a wrap-around.
+ */
+#define ARL_RING_SKIP SIZE_MAX
+
+/**
+ * @struct ArlRing
+ * @brief SPSC ring-buffer arena.
+ *
+ * Positions are free-running byte counters; the index in the buffer is `pos & mask`.
+ *
+ * Fields:
+ *   - buffer, capacity, mask: Shared, read-only after creation
+ *   - head:     Published end of the committed records (written by the producer)
+ *   - pending:  End of the records reserved but not yet committed (producer only)
+ *   - tail_seen: Producer's cached copy of tail
+ *   - tail:     Start of the oldest unreleased record (written by the consumer)
+ *   - head_seen: Consumer's cached copy of head
+ */
+typedef struct {
+	uint8_t *buffer;
+	size_t capacity;
+	size_t mask;
+
+	_Alignas(ARL_CACHE_LINE) _Atomic size_t head;
+	size_t pending;
+	size_t tail_seen;
+
+	_Alignas(ARL_CACHE_LINE) _Atomic size_t tail;
+	size_t head_seen;
+} ArlRing;
+
+/**
+ * @brief Creates a ring arena.
+ *
+ * @param ring     Pointer to the ring to initialize
+ * @param capacity Capacity in bytes, rounded up to a power of 2
+ */
+void arl_ring_new (ArlRing *ring, size_t capacity);
+
+/**
+ * @brief Releases the memory of the ring.
+ *
+ * @param ring Pointer to the ring
+ */
+void arl_ring_free (ArlRing *ring);
+
+/**
+ * @brief Reserves a record at the head (producer side).
+ *
+ * The record is not visible to the consumer until arl_ring_commit(). Several records
+ * may be reserved before a single commit.
+ *
+ * @param ring Pointer to the ring
+ * @param size Size of the record in bytes
+ * @return Pointer to the record (ARL_ALIGN-aligned), or NULL if the ring is full
+ */
+static inline void* arl_ring_alloc (ArlRing *ring, size_t size) {
+	size_t record = arl_align_up(ARL_RING_HEADER + size, ARL_ALIGN);
+	size_t pos    = ring->pending;
+	size_t index  = pos & ring->mask;
+	size_t skip   = 0;
+
+	if (record > ring->capacity - index) {
+		skip = ring->capacity - index;
+	}
+
+	size_t stop = pos + skip + record;
+	if (stop - ring->tail_seen > ring->capacity) {
+		ring->tail_seen = atomic_load_explicit(&ring->tail, memory_order_acquire);
+		if (stop - ring->tail_seen > ring->capacity) {
+			return NULL;
+		}
+	}
+
+	if (skip != 0) {
+		*(size_t*)(ring->buffer + index) = ARL_RING_SKIP;
+		index = 0;
+	}
+
+	*(size_t*)(ring->buffer + index) = size;
+	ring->pending = stop;
+	return ring->buffer + index + ARL_RING_HEADER;
+}
+
+/**
+ * @brief Publishes every record reserved since the last commit (producer side).
+ *
+ * @param ring Pointer to the ring
+ */
+static inline void arl_ring_commit (ArlRing *ring) {
+	atomic_store_explicit(&ring->head, ring->pending, memory_order_release);
+}
+
+/**
+ * @brief Returns the oldest committed record without releasing it (consumer side).
+ *
+ * @param ring Pointer to the ring
+ * @param size Receives the size of the record (may be NULL)
+ * @return Pointer to the record, or NULL if the ring is empty
+ */
+static inline void* arl_ring_peek (ArlRing *ring, size_t *size) {
+	size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	for (;;) {
+		if (pos == ring->head_seen) {
+			ring->head_seen = atomic_load_explicit(&ring->head, memory_order_acquire);
+			if (pos == ring->head_seen) {
+				return NULL;
+			}
+		}
+
+		size_t index  = pos & ring->mask;
+		size_t length = *(size_t*)(ring->buffer + index);
+
+		if (length != ARL_RING_SKIP) {
+			if (size != NULL) {
+				*size = length;
+			}
+			return ring->buffer + index + ARL_RING_HEADER;
+		}
+
+		pos += ring->capacity - index;
+		atomic_store_explicit(&ring->tail, pos, memory_order_release);
+	}
+}
+
+/**
+ * @brief Releases the oldest record, returning its space to the producer (consumer side).
+ *
+ * Must follow a successful arl_ring_peek().
+ *
+ * @param ring Pointer to the ring
+ */
+static inline void arl_ring_release (ArlRing *ring) {
+	size_t pos    = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	size_t length = *(size_t*)(ring->buffer + (pos & ring->mask));
+
+	pos += arl_align_up(ARL_RING_HEADER + length, ARL_ALIGN);
+	atomic_store_explicit(&ring->tail, pos, memory_order_release);
+}
+
+#endif
@@ -45,6 +45,29 @@
 		} while (0);
 #endif
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def ARL_BUDGET_TAGS
+ * @brief Number of budget tags, tag 0 ("untagged") included.
+ */
+#ifndef ARL_BUDGET_TAGS
+	#define ARL_BUDGET_TAGS 16
+#endif
+
+/**
+ * @brief Callback fired when the process crosses the soft memory limit.
+ *
+ * Runs on the allocating thread, inside the system allocation: it should only
+ * signal owners to trim their caches (see arl_trim), not allocate from arenas.
+ *
+ * @param used Bytes mapped by Armel, the new mapping included
+ * @param ctx  Context given to arl_budget_set()
+ */
+typedef void (*ArlBudgetFn) (size_t used, void *ctx);
+
 /**
  * @brief Allocates a memory region of the given size using system-specific calls.
  *
@@ -52,11 +75,22 @@
  * On Windows: uses VirtualAlloc.
  * This function is intended for internal use by arl_new().
  *
+ * The region is charged to the budget as untagged (tag 0).
+ *
  * @param size Number of bytes to allocate (must already be aligned)
  * @return Pointer to the allocated memory (never NULL or MAP_FAILED — use ARL_ASSERT_FATAL)
  */
 void* arl_sys_alloc(size_t size);
 
+/**
+ * @brief Allocates a memory region charged to `tag`, without aborting.
+ *
+ * @param size Number of bytes to allocate (must already be aligned)
+ * @param tag  Budget tag (see arl_budget_tag)
+ * @return Pointer to the memory, or NULL if the hard limit or the system refused it
+ */
+void* arl_sys_try_alloc(size_t size, int tag);
+
 /**
  * @brief Frees a memory region allocated by arl_sys_alloc.
  *
@@ -69,4 +103,110 @@ void* arl_sys_alloc(size_t size);
  */
 void  arl_sys_free(void* ptr, size_t size);
 
+/**
+ * @brief Frees a region allocated by arl_sys_try_alloc with the same tag.
+ *
+ * @param ptr  Pointer to the memory block to free
+ * @param size Original size of the memory block
+ * @param tag  Tag it was charged to
+ */
+void  arl_sys_free_tag(void* ptr, size_t size, int tag);
+
+/**
+ * @brief Returns the granularity of system mappings.
+ *
+ * On UNIX: the page size.
+ * On Windows: the allocation granularity (64 KB), which mirrored mappings must respect.
+ *
+ * @return Granularity in bytes (a power of 2)
+ */
+size_t arl_sys_page_size(void);
+
+/**
+ * @brief Maps a memory region twice, back-to-back, in virtual memory.
+ *
+ * Returns `2 * size` bytes of address space where the second half is the same
+ * physical memory as the first: writing at `ptr + i` is visible at `ptr + size + i`.
+ * Any span of at most `size` bytes starting in the first half is contiguous.
+ *
+ * On Linux: uses memfd_create. On other UNIX: uses shm_open.
+ * On Windows: uses CreateFileMapping and two views.
+ *
+ * @param size Size of the region (must be a multiple of arl_sys_page_size())
+ * @return Pointer to the first mapping, or NULL if refused by the budget or the system
+ */
+void* arl_sys_alloc_mirror(size_t size);
+
+/**
+ * @brief Frees a region allocated by arl_sys_alloc_mirror.
+ *
+ * @param ptr  Pointer returned by arl_sys_alloc_mirror
+ * @param size Size given to arl_sys_alloc_mirror
+ */
+void  arl_sys_free_mirror(void* ptr, size_t size);
+
+/**
+ * @brief Sets process-wide limits on the memory mapped by Armel.
+ *
+ * Every system mapping is counted (arenas, chained and large blocks, rings, logs).
+ * Crossing `soft` fires `on_soft` once per crossing. Past `hard`, mappings are
+ * refused: arena creation and growth fail like an overflow (NULL with
+ * ARL_SOFTFAIL, abort otherwise).
+ *
+ * @param soft    Soft limit in bytes (0 for none)
+ * @param hard    Hard limit in bytes (0 for none)
+ * @param on_soft Callback fired when crossing the soft limit (may be NULL)
+ * @param ctx     Context passed to the callback
+ */
+void  arl_budget_set(size_t soft, size_t hard, ArlBudgetFn on_soft, void *ctx);
+
+/**
+ * @brief Returns the number of bytes currently mapped by Armel.
+ */
+size_t arl_budget_used(void);
+
+/**
+ * @brief Tells why the last failed arl_sys_try_alloc() on this thread failed.
+ *
+ * @return 1 if the hard limit refused it, 0 if the system did
+ */
+int   arl_budget_refused(void);
+
+/**
+ * @brief Registers a tag for per-component accounting (e.g. "parser", "cache").
+ *
+ * @param name Tag name (must stay valid; registering a name twice returns the same tag)
+ * @return Tag id, or -1 if ARL_BUDGET_TAGS are in use
+ */
+int   arl_budget_tag(const char *name);
+
+/**
+ * @brief Returns the name of a tag ("untagged" for tag 0).
+ */
+const char* arl_budget_tag_name(int tag);
+
+/**
+ * @brief Returns the number of bytes currently charged to a tag (unknown tags read as untagged).
+ */
+size_t arl_budget_tag_used(int tag);
+
+/**
+ * @brief Sets the tag charged by arenas created on this thread from now on.
+ *
+ * An arena keeps the tag it was created with for all its blocks.
+ *
+ * @param tag Tag id (0 for untagged; unknown tags, like -1 from a full table, fall back to 0)
+ * @return The previous tag, to restore it
+ */
+int   arl_budget_use(int tag);
+
+/**
+ * @brief Returns the tag currently used on this thread.
+ */
+int   arl_budget_current(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // ARMEL_SYS_H
\ No newline at end of file
@@ -0,0 +1,317 @@
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <Armel/armel.h>
+#include "armel_preload.h"
+
+#ifndef __GLIBC__
+	#error "armel_preload needs glibc: the real allocator is reached through __libc_malloc and friends"
+#endif
+
+// glibc entry points, which dlsym(RTLD_NEXT) cannot give without allocating
+extern void* __libc_malloc (size_t size);
+extern void* __libc_calloc (size_t count, size_t size);
+extern void* __libc_realloc (void *ptr, size_t size);
+extern void  __libc_free (void *ptr);
+extern void* __libc_memalign (size_t alignment, size_t size);
+
+// malloc_usable_size has no __libc_ alias: found with dlsym on first use
+typedef size_t (*ArlUsableFn) (void *ptr);
+static _Atomic(ArlUsableFn) arl_libc_usable = NULL;
+
+// Space before each arena block: its size, for realloc
+#define ARL_PRELOAD_HEADER 16
+
+#define ARL_PRELOAD_TLS __attribute__((tls_model("initial-exec")))
+
+/**
+ * Arenas are never unmapped: a thread that exits hands its slot to the next one,
+ * and pointers into it are still recognized when freed late.
+ */
+typedef struct {
+	Armel armel;
+	atomic_int owned;
+	_Atomic(uintptr_t) start;
+	_Atomic(uintptr_t) stop;
+} ArlPreloadSlot;
+
+static ArlPreloadSlot arl_slots[ARL_PRELOAD_THREADS];
+
+// Bounds of every arena, so that most C library pointers are rejected without a scan
+static _Atomic(uintptr_t) arl_low = UINTPTR_MAX;
+static _Atomic(uintptr_t) arl_high = 0;
+
+static pthread_key_t arl_key;
+static pthread_once_t arl_once = PTHREAD_ONCE_INIT;
+
+static _Thread_local ArlPreloadSlot *arl_slot ARL_PRELOAD_TLS = NULL;
+static _Thread_local int arl_depth ARL_PRELOAD_TLS = 0;
+
+
+static void arl_preload_release (void *ctx) {
+	ArlPreloadSlot *slot = (ArlPreloadSlot*)ctx;
+
+	arl_reset(&slot->armel);
+	atomic_store_explicit(&slot->owned, 0, memory_order_release);
+}
+
+
+static void arl_preload_init (void) {
+	pthread_key_create(&arl_key, arl_preload_release);
+}
+
+
+static void arl_preload_widen (uintptr_t start, uintptr_t stop) {
+	uintptr_t low = atomic_load(&arl_low);
+	while (start < low && !atomic_compare_exchange_weak(&arl_low, &low, start)) {}
+
+	uintptr_t high = atomic_load(&arl_high);
+	while (stop > high && !atomic_compare_exchange_weak(&arl_high, &high, stop)) {}
+}
+
+
+static ArlPreloadSlot* arl_preload_claim (size_t size) {
+	pthread_once(&arl_once, arl_preload_init);
+
+	for (int i = 0; i < ARL_PRELOAD_THREADS; i++) {
+		ArlPreloadSlot *slot = &arl_slots[i];
+		int expected = 0;
+
+		if (!atomic_compare_exchange_strong(&slot->owned, &expected, 1)) {
+			continue;
+		}
+
+		if (atomic_load_explicit(&slot->stop, memory_order_acquire) == 0) {
+			arl_new_custom(&slot->armel, size ? size : ARL_PRELOAD_ARENA, ARL_PRELOAD_HEADER, ARL_SOFTFAIL);
+			if (slot->armel.base == NULL) {
+				atomic_store(&slot->owned, 0);
+				return NULL;
+			}
+
+			uintptr_t start = (uintptr_t)slot->armel.base;
+			uintptr_t stop = (uintptr_t)slot->armel.end;
+			atomic_store_explicit(&slot->start, start, memory_order_relaxed);
+			atomic_store_explicit(&slot->stop, stop, memory_order_release);
+			arl_preload_widen(start, stop);
+		}
+
+		pthread_setspecific(arl_key, slot);
+		return slot;
+	}
+	return NULL;
+}
+
+
+static void* arl_preload_alloc (size_t size, size_t alignment) {
+	if (size > SIZE_MAX / 2) {
+		return NULL;
+	}
+
+	size_t padding = alignment > ARL_PRELOAD_HEADER ? alignment - ARL_PRELOAD_HEADER : 0;
+	uint8_t *raw = (uint8_t*)arl_alloc(&arl_slot->armel, ARL_PRELOAD_HEADER + size + padding);
+	if (raw == NULL) {
+		return NULL;
+	}
+
+	uint8_t *ptr = (uint8_t*)arl_align_up((uintptr_t)raw + ARL_PRELOAD_HEADER, alignment);
+	((size_t*)ptr)[-1] = size;
+	return ptr;
+}
+
+
+static inline int arl_preload_active (void) {
+	return arl_depth > 0 && arl_slot != NULL;
+}
+
+
+void arl_preload_begin (size_t size) {
+	if (arl_slot == NULL) {
+		arl_slot = arl_preload_claim(size);
+	}
+	arl_depth++;
+}
+
+
+void arl_preload_end (void) {
+	if (arl_depth == 0) {
+		return;
+	}
+	if (--arl_depth == 0 && arl_slot != NULL) {
+		arl_reset(&arl_slot->armel);
+	}
+}
+
+
+int arl_preload_owns (const void *ptr) {
+	uintptr_t p = (uintptr_t)ptr;
+
+	if (p < atomic_load_explicit(&arl_low, memory_order_relaxed)
+		|| p >= atomic_load_explicit(&arl_high, memory_order_relaxed)) {
+		return 0;
+	}
+
+	for (int i = 0; i < ARL_PRELOAD_THREADS; i++) {
+		uintptr_t stop = atomic_load_explicit(&arl_slots[i].stop, memory_order_acquire);
+		if (p < stop && p >= atomic_load_explicit(&arl_slots[i].start, memory_order_relaxed)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+// ---- Interposed allocator ---- //
+
+void* malloc (size_t size) {
+	if (arl_preload_active()) {
+		void *ptr = arl_preload_alloc(size, ARL_PRELOAD_HEADER);
+		if (ptr != NULL) {
+			return ptr;
+		}
+	}
+	return __libc_malloc(size);
+}
+
+
+void* calloc (size_t count, size_t size) {
+	if (size != 0 && count > SIZE_MAX / size) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	// A reset arena holds old data: clear it
+	if (arl_preload_active()) {
+		void *ptr = arl_preload_alloc(count * size, ARL_PRELOAD_HEADER);
+		if (ptr != NULL) {
+			return memset(ptr, 0, count * size);
+		}
+	}
+	return __libc_calloc(count, size);
+}
+
+
+void* realloc (void *ptr, size_t size) {
+	if (ptr == NULL) {
+		return malloc(size);
+	}
+	if (!arl_preload_owns(ptr)) {
+		return __libc_realloc(ptr, size);
+	}
+
+	size_t old = ((size_t*)ptr)[-1];
+	if (size <= old) {
+		return ptr;
+	}
+
+	// Grow in place when the block is the arena's last one
+	if (arl_slot != NULL && (uint8_t*)ptr + old == (uint8_t*)arl_slot->armel.cursor
+		&& (size_t)((uint8_t*)arl_slot->armel.end - (uint8_t*)ptr) >= size) {
+		arl_slot->armel.cursor = (uint8_t*)ptr + size;
+		((size_t*)ptr)[-1] = size;
+		return ptr;
+	}
+
+	void *copy = malloc(size);
+	if (copy != NULL) {
+		memcpy(copy, ptr, old);
+	}
+	return copy;
+}
+
+
+void free (void *ptr) {
+	if (ptr == NULL || arl_preload_owns(ptr)) {
+		return;
+	}
+	__libc_free(ptr);
+}
+
+
+static void* arl_preload_aligned (size_t alignment, size_t size) {
+	if (arl_preload_active()) {
+		void *ptr = arl_preload_alloc(size, alignment < ARL_PRELOAD_HEADER ? ARL_PRELOAD_HEADER : alignment);
+		if (ptr != NULL) {
+			return ptr;
+		}
+	}
+	return __libc_memalign(alignment, size);
+}
+
+
+int posix_memalign (void **out, size_t alignment, size_t size) {
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment % sizeof(void*) != 0) {
+		return EINVAL;
+	}
+
+	void *ptr = arl_preload_aligned(alignment, size);
+	if (ptr == NULL) {
+		return ENOMEM;
+	}
+	*out = ptr;
+	return 0;
+}
+
+
+void* aligned_alloc (size_t alignment, size_t size) {
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+	return arl_preload_aligned(alignment, size);
+}
+
+
+void* memalign (size_t alignment, size_t size) {
+	return aligned_alloc(alignment, size);
+}
+
+
+void* valloc (size_t size) {
+	return arl_preload_aligned((size_t)sysconf(_SC_PAGESIZE), size);
+}
+
+
+void* pvalloc (size_t size) {
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+	if (size > SIZE_MAX - page) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	return arl_preload_aligned(page, arl_align_up(size ? size : 1, page));
+}
+
+
+// glibc's reallocarray calls __libc_realloc directly, which cannot take arena pointers
+void* reallocarray (void *ptr, size_t count, size_t size) {
+	if (size != 0 && count > SIZE_MAX / size) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	return realloc(ptr, count * size);
+}
+
+
+size_t malloc_usable_size (void *ptr) {
+	if (ptr == NULL) {
+		return 0;
+	}
+	if (arl_preload_owns(ptr)) {
+		return ((size_t*)ptr)[-1];
+	}
+
+	ArlUsableFn usable = atomic_load_explicit(&arl_libc_usable, memory_order_acquire);
+	if (usable == NULL) {
+		// dlsym may allocate: malloc is interposed, but not this function
+		usable = (ArlUsableFn)dlsym(RTLD_NEXT, "malloc_usable_size");
+		atomic_store_explicit(&arl_libc_usable, usable, memory_order_release);
+	}
+	return usable != NULL ? usable(ptr) : 0;
+}
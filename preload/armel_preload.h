@@ -0,0 +1,81 @@
+/**
+ * @file armel_preload.h
+ * @brief Request-scoped arena mode for code that calls malloc/free directly.
+ *
+ * libarmel_preload.so interposes malloc, calloc, realloc, free, posix_memalign,
+ * aligned_alloc, memalign, valloc, pvalloc, reallocarray and malloc_usable_size
+ * (load it with LD_PRELOAD, or link against it).
+ * Outside a scope every call goes to the C library.
+ *
+ * Between arl_preload_begin() and arl_preload_end(), allocations made by the
+ * calling thread, including those made inside third-party libraries, come from
+ * that thread's arena. Freeing an arena pointer does nothing (arena pointers are
+ * recognized by address range, from any thread). Closing the outermost scope
+ * resets the arena: nothing allocated in the scope may be used afterwards.
+ *
+ * When the arena is full, allocations fall back to the C library.
+ *
+ * Example:
+ * ```c
+ * arl_preload_begin(0);
+ * Document* doc = legacy_parse(request);   // mallocs thousands of nodes
+ * send_response(render(doc));
+ * arl_preload_end();                       // one reset instead of thousands of frees
+ * ```
+ *
+ * Build:
+ *     gcc -std=gnu11 -O2 -shared -fPIC -Iincludes preload/armel_preload.c \
+ *         src/armel.c src/armel_sys.c -pthread -o libarmel_preload.so
+ *
+ * Author: Vincent Huster
+ * License: Zlib
+ */
+
+#ifndef ARMEL_PRELOAD_H
+#define ARMEL_PRELOAD_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def ARL_PRELOAD_ARENA
+ * @brief Default size of a thread's scope arena (reserved on its first scope).
+ */
+#ifndef ARL_PRELOAD_ARENA
+	#define ARL_PRELOAD_ARENA ((size_t)64 * 1024 * 1024)
+#endif
+
+/**
+ * @def ARL_PRELOAD_THREADS
+ * @brief Maximum number of threads holding a scope arena at the same time.
+ */
+#ifndef ARL_PRELOAD_THREADS
+	#define ARL_PRELOAD_THREADS 256
+#endif
+
+/**
+ * @brief Opens an arena scope on the calling thread. Scopes nest.
+ *
+ * @param size Arena size for the thread's first scope, or 0 for ARL_PRELOAD_ARENA
+ *             (ignored once the thread has an arena)
+ */
+void arl_preload_begin (size_t size);
+
+/**
+ * @brief Closes the innermost scope; closing the outermost one resets the arena.
+ */
+void arl_preload_end (void);
+
+/**
+ * @brief Tells whether `ptr` was allocated from a scope arena (of any thread).
+ */
+int arl_preload_owns (const void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+// Smoke test for libarmel_preload.so, run by CI:
+//     gcc -std=gnu11 -Ipreload preload/preload_smoke.c build/libarmel_preload.so -o build/preload_smoke
+//     ./build/preload_smoke
+
+#include <assert.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "armel_preload.h"
+
+int main (void) {
+    char* outside = malloc(32);
+    outside[0] = 0;
+    assert(!arl_preload_owns(outside));
+
+    arl_preload_begin(ARL_PRELOAD_ARENA / 16);
+    char* name = strdup("request");
+    assert(arl_preload_owns(name));
+
+    // The last block grows in place
+    char* grown = realloc(name, 4096);
+    assert(grown == name && strcmp(grown, "request") == 0);
+
+    void* aligned = NULL;
+    assert(posix_memalign(&aligned, 4096, 100) == 0);
+    assert(((uintptr_t)aligned & 4095) == 0 && arl_preload_owns(aligned));
+
+    int* zeros = calloc(64, sizeof(int));
+    for (int i = 0; i < 64; i++) assert(zeros[i] == 0);
+
+    // Entry points glibc would otherwise hand arena pointers to itself
+    assert(malloc_usable_size(zeros) == 64 * sizeof(int));
+    assert(malloc_usable_size(outside) >= 32);
+    int* more = reallocarray(zeros, 128, sizeof(int));
+    assert(more == zeros && malloc_usable_size(more) == 128 * sizeof(int));
+    volatile size_t huge = SIZE_MAX / 2;
+    assert(reallocarray(more, huge, 4) == NULL);
+    void* page = valloc(100);
+    void* whole = pvalloc(100);
+    assert(((uintptr_t)page & 4095) == 0 && arl_preload_owns(page));
+    assert(((uintptr_t)whole & 4095) == 0 && malloc_usable_size(whole) % 4096 == 0);
+
+    // Nested scopes, frees of arena pointers are no-ops
+    arl_preload_begin(0);
+    free(grown);
+    free(aligned);
+    arl_preload_end();
+
+    // Outside pointers keep going to the C library
+    outside = realloc(outside, 1 << 20);
+    assert(!arl_preload_owns(outside));
+    arl_preload_end();
+
+    // The scope reset the arena: the next scope starts over
+    arl_preload_begin(0);
+    char* again = malloc(16);
+    assert(again == name);
+    arl_preload_end();
+
+    assert(!arl_preload_owns(malloc(16)));
+    free(outside);
+    puts("armel_preload: OK");
+    return 0;
+}
@@ -11,14 +11,27 @@ void arl_new_custom (Armel* armel, size_t size, size_t alignment, uint8_t flags)
 	}
 
 	size_t padded_size = arl_align_up(size, alignment);
-    void* ptr = arl_sys_alloc(padded_size);
+	int tag = arl_budget_current();
+    void* ptr = arl_sys_try_alloc(padded_size, tag);
 
-    armel->base = ptr;
-    armel->cursor = ptr;
-    armel->end = (char*)ptr + padded_size;
+	memset(armel, 0, sizeof(*armel));
 	armel->alignment = alignment;
 	armel->mask = alignment - 1;
 	armel->flags = flags;
+	armel->large = SIZE_MAX;
+	armel->tag = tag;
+
+	if (ptr == NULL) {
+		// Refused by the memory budget: an empty SOFTFAIL arena returns NULL on every allocation
+		ARL_ASSERT_FATAL(flags & ARL_SOFTFAIL, "arl_new_custom: allocation failed or memory budget exceeded");
+		return;
+	}
+
+    armel->base = ptr;
+    armel->cursor = ptr;
+    armel->end = (char*)ptr + padded_size;
+	armel->root = armel->base;
+	armel->root_end = armel->end;
 
 	if (flags & ARL_ZEROS) {
 		memset(ptr, 0, padded_size);
@@ -26,16 +39,471 @@ void arl_new_custom (Armel* armel, size_t size, size_t alignment, uint8_t flags)
 }
 
 
+static void arl_cache_drain (Armel *armel);
+
+/**
+ * @brief Rounding applied to chained blocks (one page on common platforms).
+ */
+#define ARL_BLOCK_ROUND (4 * ARL_KB)
+
+/**
+ * @brief Takes a block of at least size bytes from the arena's cache,
+ * or maps a new block of fresh bytes from the system.
+ *
+ * The smallest cached block that fits is taken (best fit), and only if it is at
+ * most 4 times what would be mapped: a small overflow does not consume a huge block.
+ */
+static ArlRecord* arl_cache_take (Armel *armel, size_t size, size_t fresh) {
+	if (__atomic_load_n(&armel->inbox, __ATOMIC_RELAXED) != NULL) {
+		arl_cache_drain(armel);
+	}
+
+	if (size > SIZE_MAX - ARL_BLOCK_ROUND) {
+		// Rounding the block size up would wrap
+		ARL_ASSERT_FATAL(armel->flags & ARL_SOFTFAIL, "Armel arena error: block size out of range");
+		return NULL;
+	}
+	if (fresh > SIZE_MAX - ARL_BLOCK_ROUND) {
+		fresh = size;
+	}
+
+	fresh = arl_align_up(fresh > size ? fresh : size, ARL_BLOCK_ROUND);
+	size_t limit = fresh <= SIZE_MAX / 4 ? fresh * 4 : SIZE_MAX;
+	ArlRecord **best = NULL;
+
+	for (ArlRecord **link = &armel->spare; *link != NULL; link = &(*link)->prev) {
+		size_t have = (*link)->size;
+		if (have >= size && have <= limit && (best == NULL || have < (*best)->size)) {
+			best = link;
+		}
+	}
+
+	if (best != NULL) {
+		ArlRecord *block = *best;
+		*best = block->prev;
+		return block;
+	}
+
+	ArlRecord *block = (ArlRecord*)arl_sys_try_alloc(fresh, armel->tag);
+
+	if (block == NULL) {
+		ARL_ASSERT_FATAL(armel->flags & ARL_SOFTFAIL, arl_budget_refused()
+			? "Armel arena error: memory budget exceeded"
+			: "Armel arena error: system allocation failed");
+		return NULL;
+	}
+	block->size = fresh;
+	return block;
+}
+
+/**
+ * @brief Returns a block to the arena's cache, or to the system once the cache
+ * holds ARL_CACHE_MAX blocks or ARL_CACHE_BYTES bytes.
+ */
+static void arl_cache_give (Armel *armel, ArlRecord *block) {
+	size_t count = 0;
+	size_t bytes = block->size;
+	for (ArlRecord *it = armel->spare; it != NULL; it = it->prev) {
+		count++;
+		bytes += it->size;
+	}
+
+	if (count >= ARL_CACHE_MAX || bytes > ARL_CACHE_BYTES) {
+		arl_sys_free_tag(block, block->size, armel->tag);
+		return;
+	}
+
+	block->prev = armel->spare;
+	armel->spare = block;
+}
+
+/**
+ * @brief Moves the blocks handed back by other threads into the cache.
+ */
+static void arl_cache_drain (Armel *armel) {
+	ArlRecord *block = __atomic_exchange_n(&armel->inbox, NULL, __ATOMIC_ACQUIRE);
+
+	while (block != NULL) {
+		ArlRecord *next = block->prev;
+		arl_cache_give(armel, block);
+		block = next;
+	}
+}
+
+static void arl_release_block (Armel *armel, ArlRecord *record) {
+	arl_cache_give(armel, record);
+}
+
+static void arl_release_malloc (Armel *armel, ArlRecord *record) {
+	(void)armel;
+	free(record);
+}
+
+
+void arl_record_push (Armel *armel, ArlRecord *record, ArlReleaseFn release, size_t extent) {
+	record->prev = armel->records;
+	record->release = release;
+	record->base = armel->base;
+	record->end = armel->end;
+	record->offset = armel->offset;
+	record->floor = armel->floor;
+	record->mark = arl_offset(armel);
+
+	armel->offset += extent;
+	armel->floor = arl_offset(armel);
+	armel->records = record;
+}
+
+
+void arl_unwind (Armel *armel, uintptr_t offset) {
+	ArlRecord *record;
+
+	while ((record = armel->records) != NULL && offset <= record->mark) {
+		armel->records = record->prev;
+		armel->base = record->base;
+		armel->end = record->end;
+		armel->offset = record->offset;
+		armel->floor = record->floor;
+		record->release(armel, record);
+	}
+
+	uintptr_t limit = (uintptr_t)armel->end - (uintptr_t)armel->base;
+	ARL_CHECK(offset >= armel->offset && offset - armel->offset <= limit,
+		"arl_rewind_to : offset out of bounds");
+
+	armel->cursor = (uint8_t*)armel->base + (offset - armel->offset);
+}
+
+
+/**
+ * @brief Allocates a record inside the arena itself and pushes it.
+ *
+ * The record's mark is the offset before its own allocation, so rewinding to
+ * an offset taken before this call releases it, and one taken after does not.
+ *
+ * @return The record (of `size` bytes), or NULL if the arena has no room
+ */
+static ArlRecord* arl_record_place (Armel *armel, size_t size, ArlReleaseFn release) {
+	uintptr_t mark = arl_offset(armel);
+	ArlRecord *record = (ArlRecord*)arl_alloc(armel, size);
+
+	if (record != NULL) {
+		arl_record_push(armel, record, release, 0);
+		record->mark = mark;
+	}
+	return record;
+}
+
+
+/**
+ * @struct ArlDeferred
+ * @brief In-arena record running a finalizer (see arl_defer).
+ */
+typedef struct {
+	ArlRecord record;
+	ArlDeferFn fn;
+	void *ctx;
+} ArlDeferred;
+
+static void arl_release_deferred (Armel *armel, ArlRecord *record) {
+	ArlDeferred *deferred = (ArlDeferred*)record;
+
+	(void)armel;
+	deferred->fn(deferred->ctx);
+}
+
+
+int arl_defer (Armel *armel, ArlDeferFn fn, void *ctx) {
+	ArlDeferred *deferred = (ArlDeferred*)arl_record_place(armel, sizeof(ArlDeferred), arl_release_deferred);
+
+	if (deferred == NULL) {
+		return 0;
+	}
+	deferred->fn = fn;
+	deferred->ctx = ctx;
+	return 1;
+}
+
+
+/**
+ * @brief Makes a cached or fresh block the current one, continuing the arena offset.
+ * @return The aligned start of the block's data.
+ */
+static void* arl_enter_block (Armel *armel, ArlRecord *block) {
+	arl_record_push(armel, block, arl_release_block, 0);
+
+	uint8_t *data = (uint8_t*)arl_align_up((uintptr_t)(block + 1), armel->alignment);
+	armel->base   = data;
+	armel->cursor = data;
+	armel->end    = (uint8_t*)block + block->size;
+	armel->offset = block->mark;
+	return data;
+}
+
+
+/**
+ * @brief Serves a request above the large threshold from a dedicated block.
+ */
+static void* arl_alloc_large (Armel *armel, size_t size) {
+	if (size > SIZE_MAX - sizeof(ArlRecord) - armel->mask) {
+		return (armel->flags & ARL_SOFTFAIL) ? NULL : arl_overflow_abort(armel, size, NULL);
+	}
+
+	size_t needed = sizeof(ArlRecord) + armel->mask + size;
+	ArlRecord *block = arl_cache_take(armel, needed, needed);
+
+	if (block == NULL) {
+		return NULL;
+	}
+	arl_record_push(armel, block, arl_release_block, size);
+	return (void*)arl_align_up((uintptr_t)(block + 1), armel->alignment);
+}
+
+
+void* arl_alloc_slow (Armel *armel, size_t size) {
+	ArlOverflowFn overflow = armel->overflow;
+	void *ptr;
+
+	if (size > armel->large) {
+		ptr = arl_alloc_large(armel, size);
+	} else {
+		if (overflow == NULL) {
+			overflow = (armel->flags & ARL_SOFTFAIL) ? arl_overflow_null : arl_overflow_abort;
+		}
+		ptr = overflow(armel, size, armel->overflow_ctx);
+	}
+
+	if (ptr != NULL && (armel->flags & ARL_ZEROS)) {
+		memset(ptr, 0, size);
+	}
+	return ptr;
+}
+
+
+void* arl_overflow_abort (Armel *armel, size_t size, void *ctx) {
+	(void)ctx;
+	uintptr_t start = arl_align_up((uintptr_t)armel->cursor, armel->alignment);
+	uintptr_t end   = (uintptr_t)armel->end;
+
+	fprintf(stderr, "Armel arena error: out of memory.\n"
+					"  Requested : %zu bytes\n"
+					"  Remaining : %zu bytes\n"
+					"  Cursor    : %p\n"
+					"  End       : %p\n",
+				size, (size_t)(start < end ? end - start : 0), armel->cursor, armel->end);
+	abort();
+}
+
+
+void* arl_overflow_null (Armel *armel, size_t size, void *ctx) {
+	(void)armel;
+	(void)size;
+	(void)ctx;
+	return NULL;
+}
+
+
+void* arl_overflow_grow (Armel *armel, size_t size, void *ctx) {
+	if (size > SIZE_MAX - sizeof(ArlRecord) - armel->mask) {
+		// The block size would wrap: no block can back this request
+		return (armel->flags & ARL_SOFTFAIL) ? NULL : arl_overflow_abort(armel, size, ctx);
+	}
+
+	size_t current = (uintptr_t)armel->end - (uintptr_t)armel->base;
+	size_t needed  = sizeof(ArlRecord) + armel->mask + size;
+	size_t wanted  = current * 2 > needed ? current * 2 : needed;
+
+	ArlRecord *block = arl_cache_take(armel, needed, wanted);
+
+	if (block == NULL) {
+		return NULL;
+	}
+	void *data = arl_enter_block(armel, block);
+
+	armel->cursor = (uint8_t*)data + size;
+	return data;
+}
+
+
+void* arl_overflow_malloc (Armel *armel, size_t size, void *ctx) {
+	if (size > SIZE_MAX - sizeof(ArlRecord) - armel->mask) {
+		return (armel->flags & ARL_SOFTFAIL) ? NULL : arl_overflow_abort(armel, size, ctx);
+	}
+
+	ArlRecord *record = (ArlRecord*)malloc(sizeof(ArlRecord) + armel->mask + size);
+
+	if (record == NULL) {
+		return NULL;
+	}
+
+	record->size = size;
+	arl_record_push(armel, record, arl_release_malloc, size);
+	return (void*)arl_align_up((uintptr_t)(record + 1), armel->alignment);
+}
+
+
+void* arl_overflow_parent (Armel *armel, size_t size, void *ctx) {
+	(void)armel;
+	Armel *parent = (Armel*)ctx;
+	ARL_CHECK(parent != NULL, "arl_overflow_parent: parent arena is NULL");
+	return arl_alloc(parent, size);
+}
+
+
+uintptr_t arl_detach_mark (Armel *armel) {
+	size_t current = (uintptr_t)armel->end - (uintptr_t)armel->base;
+	ArlRecord *block = arl_cache_take(armel, sizeof(ArlRecord) + armel->mask, current);
+
+	if (block != NULL) {
+		arl_enter_block(armel, block);
+	}
+	return arl_offset(armel);
+}
+
+
+ArlDetached arl_detach (Armel *armel, uintptr_t mark) {
+	ArlDetached handle = { NULL, armel, arl_offset(armel) - mark };
+	uintptr_t in_block = (uintptr_t)armel->cursor - (uintptr_t)armel->base;
+	ArlRecord *record;
+	ArlRecord *lowest = NULL;
+	ArlRecord **tail = &handle.records;
+
+	ARL_CHECK(mark <= arl_offset(armel), "arl_detach: mark is past the cursor");
+
+	while ((record = armel->records) != NULL && record->mark >= mark) {
+		if (record->base != armel->base) {
+			// Leaving a chained block: bytes used in the block below when it was left
+			in_block = record->mark - record->offset;
+		}
+
+		armel->records = record->prev;
+		armel->base = record->base;
+		armel->end = record->end;
+		armel->offset = record->offset;
+		armel->floor = record->floor;
+
+		// Kept top-first, like the arena's stack: finalizers run in reverse order
+		record->prev = NULL;
+		*tail = record;
+		tail = &record->prev;
+		lowest = record;
+	}
+
+	ARL_CHECK((lowest == NULL || lowest->mark == mark) && in_block == mark - armel->offset,
+		"arl_detach: data allocated after mark is not at the start of a block (see arl_detach_mark)");
+
+	armel->cursor = (uint8_t*)armel->base + (mark - armel->offset);
+	return handle;
+}
+
+
+/**
+ * @struct ArlAttached
+ * @brief In-arena record owning a detached handle (see arl_attach).
+ */
+typedef struct {
+	ArlRecord record;
+	ArlDetached handle;
+} ArlAttached;
+
+static void arl_release_attached (Armel *armel, ArlRecord *record) {
+	(void)armel;
+	arl_release(&((ArlAttached*)record)->handle);
+}
+
+
+void arl_attach (Armel *armel, ArlDetached *handle) {
+	ArlAttached *attached = (ArlAttached*)arl_record_place(armel, sizeof(ArlAttached), arl_release_attached);
+
+	ARL_CHECK(attached != NULL, "arl_attach: no room for the ownership record");
+
+	attached->handle = *handle;
+
+	handle->records = NULL;
+	handle->size = 0;
+}
+
+
+void arl_release (ArlDetached *handle) {
+	Armel *origin = handle->origin;
+	ArlRecord *record = handle->records;
+	ArlRecord *blocks = NULL;
+
+	// Finalizers first, top-down: their records may live in the detached blocks
+	while (record != NULL) {
+		ArlRecord *next = record->prev;
+
+		if (record->release == arl_release_block) {
+			record->prev = blocks;
+			blocks = record;
+		} else {
+			record->release(origin, record);
+		}
+		record = next;
+	}
+
+	// The origin's cache belongs to its thread: blocks go through its inbox
+	while (blocks != NULL) {
+		ArlRecord *next = blocks->prev;
+		ArlRecord *top = __atomic_load_n(&origin->inbox, __ATOMIC_RELAXED);
+
+		do {
+			blocks->prev = top;
+		} while (!__atomic_compare_exchange_n(&origin->inbox, &top, blocks, 1,
+					__ATOMIC_RELEASE, __ATOMIC_RELAXED));
+		blocks = next;
+	}
+
+	handle->records = NULL;
+	handle->size = 0;
+}
+
+
+void arl_observe_peak (Armel *armel) {
+	uintptr_t peak = arl_offset(armel);
+
+	if (armel->peak > peak) {
+		peak = armel->peak;
+	}
+	armel->peak = 0;
+	armel->observer(armel, (size_t)peak, armel->observer_ctx);
+}
+
+
+void arl_trim (Armel *armel) {
+	arl_cache_drain(armel);
+
+	while (armel->spare != NULL) {
+		ArlRecord *block = armel->spare;
+		armel->spare = block->prev;
+		arl_sys_free_tag(block, block->size, armel->tag);
+	}
+}
+
+
 void arl_free (Armel *armel) {
-	size_t size = (uintptr_t)armel->end - (uintptr_t)armel->base;
+	if (armel->observer != NULL) {
+		arl_observe_peak(armel);
+	}
+	if (armel->records != NULL) {
+		arl_unwind(armel, 0);
+	}
+	arl_trim(armel);
 
-	arl_sys_free(armel->base, size);
+	if (armel->base != NULL) {
+		size_t size = (uintptr_t)armel->end - (uintptr_t)armel->base;
+		arl_sys_free_tag(armel->base, size, armel->tag);
+	}
 
 	armel->base = NULL;
 	armel->cursor = NULL;
 	armel->end  = NULL;
+	armel->root = NULL;
+	armel->root_end = NULL;
 	armel->flags = 0;
 	armel->alignment = 0;
+	armel->offset = 0;
+	armel->floor = 0;
 }
 
 
@@ -44,8 +512,26 @@ void arl_print_info (Armel *armel) {
 	printf("  base      = %p\n", armel->base);
 	printf("  cursor    = %p\n", armel->cursor);
 	printf("  end       = %p\n", armel->end);
+	printf("  offset    = %zu bytes (logical, across blocks)\n", (size_t)arl_offset(armel));
 	printf("  used      = %zu bytes\n", arl_used(armel));
-	printf("  remaining = %zu bytes\n", arl_remaining(armel));
+	printf("  remaining = %zu bytes (current block)\n", arl_remaining(armel));
+
+	size_t blocks = 0, block_bytes = 0, others = 0;
+	for (ArlRecord *record = armel->records; record != NULL; record = record->prev) {
+		if (record->release == arl_release_block) {
+			blocks++;
+			block_bytes += record->size;
+		} else {
+			others++;
+		}
+	}
+	size_t cached = 0, cached_bytes = 0;
+	for (ArlRecord *block = armel->spare; block != NULL; block = block->prev) {
+		cached++;
+		cached_bytes += block->size;
+	}
+	printf("  chained   = %zu blocks, %zu bytes (+ %zu other records)\n", blocks, block_bytes, others);
+	printf("  cached    = %zu blocks, %zu bytes\n", cached, cached_bytes);
 	printf("  alignment = %zu\n", (size_t)armel->alignment);
 	printf("  flags     = 0x%02X", armel->flags);
 
@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_bitmap.h>
+
+void arl_bitmap_new (ArlBitmap *pool, Armel *armel, size_t size, size_t page) {
+	page = page ? page : ARL_BITMAP_PAGE;
+	size = arl_align_up(size ? size : 1, armel->alignment);
+
+	ARL_CHECK((page & (page - 1)) == 0, "arl_bitmap_new: page size must be a power of 2");
+
+	// The bitmap depends on the slot count, which depends on the header size
+	size_t slots = (page - sizeof(ArlBitmapPage)) / size;
+	size_t words = (slots + 63) / 64;
+	size_t header = arl_align_up(sizeof(ArlBitmapPage) + words * sizeof(uint64_t), armel->alignment);
+
+	ARL_CHECK(page > header && page - header >= size, "arl_bitmap_new: page too small for one block");
+
+	slots = (page - header) / size;
+	if (slots > words * 64) {
+		slots = words * 64;
+	}
+	if (slots > ARL_BITMAP_SLOTS) {
+		slots = ARL_BITMAP_SLOTS;
+	}
+
+	pool->armel = armel;
+	pool->size = size;
+	pool->page = page;
+	pool->header = header;
+	pool->slots = (uint32_t)slots;
+	pool->scale = (((uint64_t)1 << 32) + size - 1) / size;
+	pool->current = NULL;
+	pool->partial = NULL;
+	pool->empty = NULL;
+}
+
+
+static ArlBitmapPage* arl_bitmap_carve (ArlBitmap *pool) {
+	Armel *armel = pool->armel;
+	size_t page = pool->page;
+
+	// Pages carved back to back need no padding; a new block may need up to a page
+	uintptr_t cursor = arl_align_up((uintptr_t)armel->cursor, armel->alignment);
+	size_t need = (arl_align_up(cursor, page) - cursor) + page;
+
+	if (need > arl_remaining(armel) || need > armel->large) {
+		need = 2 * page - armel->alignment;
+	}
+
+	uint8_t *raw = (uint8_t*)arl_alloc(armel, need);
+	if (raw == NULL) {
+		return NULL;
+	}
+
+	ArlBitmapPage *result = (ArlBitmapPage*)arl_align_up((uintptr_t)raw, page);
+	uint32_t words = (pool->slots + 63) / 64;
+
+	for (uint32_t w = 0; w < words; w++) {
+		result->free[w] = ~(uint64_t)0;
+	}
+	if (pool->slots % 64) {
+		result->free[words - 1] = ((uint64_t)1 << (pool->slots % 64)) - 1;
+	}
+	result->summary = words == 64 ? ~(uint64_t)0 : ((uint64_t)1 << words) - 1;
+	result->live = 0;
+	result->next = NULL;
+	result->prev = NULL;
+	return result;
+}
+
+
+void* arl_bitmap_refill (ArlBitmap *pool) {
+	ArlBitmapPage *page;
+
+	if (pool->partial != NULL) {
+		page = pool->partial;
+		pool->partial = page->next;
+		if (pool->partial != NULL) {
+			pool->partial->prev = NULL;
+		}
+	} else if (pool->empty != NULL) {
+		page = pool->empty;
+		pool->empty = page->next;
+	} else {
+		page = arl_bitmap_carve(pool);
+		if (page == NULL) {
+			return NULL;
+		}
+	}
+
+	// The full page leaves every list; its next free puts it back on the partial list
+	pool->current = page;
+	page->next = NULL;
+	page->prev = NULL;
+	return arl_bitmap_alloc(pool);
+}
+
+
+void arl_bitmap_settle (ArlBitmap *pool, ArlBitmapPage *page, int was_full) {
+	Armel *armel = pool->armel;
+
+	if (page == pool->current) {
+		return;
+	}
+
+	// A page that was full is on no list
+	if (!was_full) {
+		if (page->prev != NULL) {
+			page->prev->next = page->next;
+		} else {
+			pool->partial = page->next;
+		}
+		if (page->next != NULL) {
+			page->next->prev = page->prev;
+		}
+	}
+
+	if (page->live != 0) {
+		page->prev = NULL;
+		page->next = pool->partial;
+		if (pool->partial != NULL) {
+			pool->partial->prev = page;
+		}
+		pool->partial = page;
+		return;
+	}
+
+	// Give the page back if nothing was allocated after it, keep it otherwise
+	uint8_t *start = (uint8_t*)page;
+	if (start + pool->page == (uint8_t*)armel->cursor && start >= (uint8_t*)armel->base
+		&& armel->offset + (uintptr_t)(start - (uint8_t*)armel->base) >= armel->floor) {
+		armel->cursor = start;
+		return;
+	}
+
+	page->next = pool->empty;
+	pool->empty = page;
+}
+
+
+void arl_bitmap_reset (ArlBitmap *pool) {
+	pool->current = NULL;
+	pool->partial = NULL;
+	pool->empty = NULL;
+}
@@ -0,0 +1,192 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <Armel/armel_sys.h>
+#include <Armel/armel.h>
+#include <Armel/armel_buddy.h>
+
+static size_t arl_buddy_words (size_t size, unsigned order) {
+	size_t blocks = (size >> ARL_BUDDY_MIN_SHIFT) >> order;
+	return (blocks + 63) / 64;
+}
+
+
+static size_t arl_buddy_meta_size (size_t size) {
+	size_t words = 0;
+	for (unsigned order = 0; order < ARL_BUDDY_ORDERS; order++) {
+		words += arl_buddy_words(size, order);
+	}
+	return words * sizeof(uint64_t);
+}
+
+
+static unsigned arl_buddy_order (size_t size) {
+	unsigned order = 0;
+	while ((ARL_BUDDY_MIN << order) < size) {
+		order++;
+	}
+	return order;
+}
+
+
+static void arl_buddy_push (ArlBuddy *buddy, unsigned order, size_t index) {
+	ArlBuddyNode *node = (ArlBuddyNode*)(buddy->base + (index << (ARL_BUDDY_MIN_SHIFT + order)));
+
+	node->prev = NULL;
+	node->next = buddy->free[order];
+	if (node->next != NULL) {
+		node->next->prev = node;
+	}
+	buddy->free[order] = node;
+	buddy->bits[order][index / 64] |= (uint64_t)1 << (index % 64);
+}
+
+
+static void arl_buddy_unlink (ArlBuddy *buddy, unsigned order, size_t index) {
+	ArlBuddyNode *node = (ArlBuddyNode*)(buddy->base + (index << (ARL_BUDDY_MIN_SHIFT + order)));
+
+	if (node->prev != NULL) {
+		node->prev->next = node->next;
+	} else {
+		buddy->free[order] = node->next;
+	}
+	if (node->next != NULL) {
+		node->next->prev = node->prev;
+	}
+	buddy->bits[order][index / 64] &= ~((uint64_t)1 << (index % 64));
+}
+
+
+static int arl_buddy_is_free (const ArlBuddy *buddy, unsigned order, size_t index) {
+	size_t blocks = (buddy->size >> ARL_BUDDY_MIN_SHIFT) >> order;
+	return index < blocks && (buddy->bits[order][index / 64] >> (index % 64)) & 1;
+}
+
+
+static void arl_buddy_init (ArlBuddy *buddy, uint8_t *base, size_t size, uint64_t *meta) {
+	buddy->base = base;
+	buddy->size = size;
+	buddy->available = size;
+
+	memset(meta, 0, arl_buddy_meta_size(size));
+	for (unsigned order = 0; order < ARL_BUDDY_ORDERS; order++) {
+		buddy->free[order] = NULL;
+		buddy->bits[order] = meta;
+		meta += arl_buddy_words(size, order);
+	}
+
+	// Cover the region with the largest blocks aligned on their own size
+	size_t offset = 0;
+	while (offset < size) {
+		unsigned order = ARL_BUDDY_ORDERS - 1;
+		while ((offset & ((ARL_BUDDY_MIN << order) - 1)) != 0 || offset + (ARL_BUDDY_MIN << order) > size) {
+			order--;
+		}
+		arl_buddy_push(buddy, order, offset >> (ARL_BUDDY_MIN_SHIFT + order));
+		offset += ARL_BUDDY_MIN << order;
+	}
+}
+
+
+int arl_buddy_new (ArlBuddy *buddy, Armel *armel, size_t size, size_t alignment) {
+	alignment = alignment ? alignment : armel->alignment;
+	size &= ~(ARL_BUDDY_MIN - 1);
+
+	ARL_CHECK((alignment & (alignment - 1)) == 0 && alignment <= ARL_BUDDY_MIN,
+		"arl_buddy_new: alignment must be a power of 2 no larger than ARL_BUDDY_MIN");
+	ARL_CHECK(size > 0, "arl_buddy_new: region smaller than ARL_BUDDY_MIN");
+
+	size_t padding = alignment > armel->alignment ? alignment - armel->alignment : 0;
+	uint8_t *raw = (uint8_t*)arl_alloc(armel, size + padding);
+	uint64_t *meta = (uint64_t*)arl_alloc(armel, arl_buddy_meta_size(size));
+
+	if (raw == NULL || meta == NULL) {
+		return 0;
+	}
+
+	arl_buddy_init(buddy, (uint8_t*)arl_align_up((uintptr_t)raw, alignment), size, meta);
+	buddy->mapping = NULL;
+	buddy->mapped = 0;
+	buddy->tag = 0;
+	return 1;
+}
+
+
+int arl_buddy_new_mapped (ArlBuddy *buddy, size_t size) {
+	size = arl_align_up(size, ARL_BUDDY_MIN);
+
+	// The bitmaps go after the region, in the same mapping
+	size_t mapped = arl_align_up(size + arl_buddy_meta_size(size), arl_sys_page_size());
+	int tag = arl_budget_current();
+	uint8_t *mapping = (uint8_t*)arl_sys_try_alloc(mapped, tag);
+
+	if (mapping == NULL) {
+		return 0;
+	}
+
+	arl_buddy_init(buddy, mapping, size, (uint64_t*)(mapping + size));
+	buddy->mapping = mapping;
+	buddy->mapped = mapped;
+	buddy->tag = tag;
+	return 1;
+}
+
+
+void arl_buddy_destroy (ArlBuddy *buddy) {
+	if (buddy->mapping != NULL) {
+		arl_sys_free_tag(buddy->mapping, buddy->mapped, buddy->tag);
+	}
+	memset(buddy, 0, sizeof(*buddy));
+}
+
+
+void* arl_buddy_alloc (ArlBuddy *buddy, size_t size) {
+	if (size > ARL_BUDDY_MAX) {
+		return NULL;
+	}
+
+	unsigned order = arl_buddy_order(size);
+	unsigned from = order;
+	while (from < ARL_BUDDY_ORDERS && buddy->free[from] == NULL) {
+		from++;
+	}
+	if (from == ARL_BUDDY_ORDERS) {
+		return NULL;
+	}
+
+	uint8_t *block = (uint8_t*)buddy->free[from];
+	size_t index = (size_t)(block - buddy->base) >> (ARL_BUDDY_MIN_SHIFT + from);
+	arl_buddy_unlink(buddy, from, index);
+
+	// Split down, keeping the lower half and freeing the upper one at each order
+	while (from > order) {
+		from--;
+		index <<= 1;
+		arl_buddy_push(buddy, from, index | 1);
+	}
+
+	buddy->available -= ARL_BUDDY_MIN << order;
+	return block;
+}
+
+
+void arl_buddy_free (ArlBuddy *buddy, void *ptr, size_t size) {
+	unsigned order = arl_buddy_order(size);
+	size_t offset = (size_t)((uint8_t*)ptr - buddy->base);
+	size_t index = offset >> (ARL_BUDDY_MIN_SHIFT + order);
+
+	ARL_CHECK(offset < buddy->size && (offset & ((ARL_BUDDY_MIN << order) - 1)) == 0,
+		"arl_buddy_free: pointer is not a block of this size");
+	ARL_CHECK(!arl_buddy_is_free(buddy, order, index), "arl_buddy_free: block already free");
+
+	buddy->available += ARL_BUDDY_MIN << order;
+
+	// Merge with the buddy while it is free, one order at a time
+	while (order + 1 < ARL_BUDDY_ORDERS && arl_buddy_is_free(buddy, order, index ^ 1)) {
+		arl_buddy_unlink(buddy, order, index ^ 1);
+		index >>= 1;
+		order++;
+	}
+	arl_buddy_push(buddy, order, index);
+}
@@ -0,0 +1,230 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_clone.h>
+
+/**
+ * @struct ArlCloneEntry
+ * @brief Object found by the first pass, and its place in the copy.
+ */
+typedef struct {
+	const void *original;
+	size_t size;
+	size_t offset;
+	ArlRelocateFn relocate;
+} ArlCloneEntry;
+
+/**
+ * @struct ArlClone
+ * @brief Cloning state.
+ *
+ * Fields:
+ *   - scratch:  Arena holding the entries and the index
+ *   - entries:  Objects in discovery order (also the first pass's queue)
+ *   - count, capacity: Entries used and allocated
+ *   - index:    Open-addressing table of entry numbers + 1, by original address
+ *   - slots:    Size of the index (power of 2)
+ *   - total:    Bytes of the packed copy so far
+ *   - align:    Largest alignment seen
+ *   - copy:     Start of the copy, NULL during the first pass
+ *   - failed:   Set when the scratch arena ran out of room
+ */
+struct ArlClone {
+	Armel *scratch;
+	ArlCloneEntry *entries;
+	size_t count;
+	size_t capacity;
+	uint32_t *index;
+	size_t slots;
+	size_t total;
+	size_t align;
+	uint8_t *copy;
+	int failed;
+};
+
+static size_t arl_clone_hash (const void *ptr, size_t slots) {
+	uint64_t h = (uint64_t)(uintptr_t)ptr * 0x9E3779B97F4A7C15ull;
+	return (size_t)(h >> 32) & (slots - 1);
+}
+
+
+static ArlCloneEntry* arl_clone_find (ArlClone *clone, const void *original) {
+	size_t slot = arl_clone_hash(original, clone->slots);
+
+	while (clone->index[slot] != 0) {
+		ArlCloneEntry *entry = &clone->entries[clone->index[slot] - 1];
+		if (entry->original == original) {
+			return entry;
+		}
+		slot = (slot + 1) & (clone->slots - 1);
+	}
+	return NULL;
+}
+
+
+/**
+ * @brief Doubles the entries and the index when the index is half full.
+ *
+ * The old arrays are left in the scratch arena.
+ */
+static int arl_clone_grow (ArlClone *clone) {
+	if (clone->count < clone->capacity) {
+		return 1;
+	}
+
+	size_t capacity = clone->capacity * 2;
+	ArlCloneEntry *entries = arl_array(clone->scratch, ArlCloneEntry, capacity);
+	uint32_t *index = (uint32_t*)arl_alloc_zeroed(clone->scratch, capacity * 2 * sizeof(uint32_t));
+	if (entries == NULL || index == NULL) {
+		return 0;
+	}
+
+	memcpy(entries, clone->entries, clone->count * sizeof(ArlCloneEntry));
+	clone->entries = entries;
+	clone->capacity = capacity;
+	clone->index = index;
+	clone->slots = capacity * 2;
+
+	for (size_t i = 0; i < clone->count; i++) {
+		size_t slot = arl_clone_hash(entries[i].original, clone->slots);
+		while (index[slot] != 0) {
+			slot = (slot + 1) & (clone->slots - 1);
+		}
+		index[slot] = (uint32_t)(i + 1);
+	}
+	return 1;
+}
+
+
+static void arl_clone_add (ArlClone *clone, const void *original, size_t size, size_t align, ArlRelocateFn relocate) {
+	if (clone->failed || arl_clone_find(clone, original) != NULL) {
+		return;
+	}
+	if (!arl_clone_grow(clone)) {
+		clone->failed = 1;
+		return;
+	}
+
+	ArlCloneEntry *entry = &clone->entries[clone->count];
+	entry->original = original;
+	entry->size = size;
+	entry->offset = arl_align_up(clone->total, align);
+	entry->relocate = relocate;
+	clone->total = entry->offset + size;
+	clone->align = align > clone->align ? align : clone->align;
+
+	size_t slot = arl_clone_hash(original, clone->slots);
+	while (clone->index[slot] != 0) {
+		slot = (slot + 1) & (clone->slots - 1);
+	}
+	clone->index[slot] = (uint32_t)(++clone->count);
+}
+
+
+void arl_clone_ref (ArlClone *clone, void *field, size_t size, size_t align, ArlRelocateFn relocate) {
+	void **slot = (void**)field;
+
+	if (*slot == NULL) {
+		return;
+	}
+
+	// First pass: discover; second pass: point the copy's field at the copied target
+	if (clone->copy == NULL) {
+		arl_clone_add(clone, *slot, size, align, relocate);
+	} else {
+		ArlCloneEntry *entry = arl_clone_find(clone, *slot);
+		ARL_CHECK(entry != NULL, "arl_clone_ref: field not reported when the original was visited");
+		*slot = clone->copy + entry->offset;
+	}
+}
+
+
+/**
+ * @brief First pass: finds every reachable object and assigns its offset in the copy.
+ */
+static int arl_clone_measure (ArlClone *clone, Armel *scratch, const void *root, size_t size, size_t align, ArlRelocateFn relocate) {
+	memset(clone, 0, sizeof(*clone));
+	clone->scratch = scratch;
+	clone->capacity = 64;
+	clone->slots = 128;
+	clone->entries = arl_array(scratch, ArlCloneEntry, clone->capacity);
+	clone->index = (uint32_t*)arl_alloc_zeroed(scratch, clone->slots * sizeof(uint32_t));
+	clone->align = 1;
+
+	if (root == NULL || clone->entries == NULL || clone->index == NULL) {
+		return 0;
+	}
+
+	arl_clone_add(clone, root, size, align, relocate);
+	for (size_t i = 0; i < clone->count && !clone->failed; i++) {
+		ArlCloneEntry entry = clone->entries[i];
+		if (entry.relocate != NULL) {
+			entry.relocate(clone, (void*)entry.original);
+		}
+	}
+	return !clone->failed;
+}
+
+
+/**
+ * @brief Second pass: copies every object and rewrites the copies' pointer fields.
+ */
+static void* arl_clone_copy (ArlClone *clone, uint8_t *copy) {
+	clone->copy = copy;
+
+	for (size_t i = 0; i < clone->count; i++) {
+		memcpy(copy + clone->entries[i].offset, clone->entries[i].original, clone->entries[i].size);
+	}
+	for (size_t i = 0; i < clone->count; i++) {
+		if (clone->entries[i].relocate != NULL) {
+			clone->entries[i].relocate(clone, copy + clone->entries[i].offset);
+		}
+	}
+	return copy;
+}
+
+
+void* arl_clone_range (Armel *dst, const void *ptr, size_t size) {
+	void *copy = arl_alloc(dst, size);
+
+	if (copy != NULL) {
+		memcpy(copy, ptr, size);
+	}
+	return copy;
+}
+
+
+void* arl_clone_new (Armel *dst, Armel *scratch, const void *root, size_t size, size_t align, ArlRelocateFn relocate) {
+	ArlClone clone;
+
+	// Safe to arl_free() even when nothing gets cloned
+	memset(dst, 0, sizeof(*dst));
+
+	if (!arl_clone_measure(&clone, scratch, root, size, align, relocate)) {
+		return NULL;
+	}
+
+	// Mappings are page-aligned: the arena's alignment only has to cover the packing
+	size_t alignment = clone.align < sizeof(void*) ? sizeof(void*) : clone.align;
+	size_t bytes = arl_align_up(clone.total, alignment);
+	arl_new_custom(dst, bytes ? bytes : alignment, alignment, ARL_NOFLAG);
+	return arl_clone_copy(&clone, (uint8_t*)arl_alloc(dst, clone.total));
+}
+
+
+void* arl_clone (Armel *dst, Armel *scratch, const void *root, size_t size, size_t align, ArlRelocateFn relocate) {
+	ArlClone clone;
+
+	if (!arl_clone_measure(&clone, scratch, root, size, align, relocate)) {
+		return NULL;
+	}
+
+	size_t padding = clone.align > dst->alignment ? clone.align - dst->alignment : 0;
+	uint8_t *raw = (uint8_t*)arl_alloc(dst, clone.total + padding);
+	if (raw == NULL) {
+		return NULL;
+	}
+	return arl_clone_copy(&clone, (uint8_t*)arl_align_up((uintptr_t)raw, clone.align));
+}
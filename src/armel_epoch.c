@@ -0,0 +1,142 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_epoch.h>
+
+void arl_epoch_init (ArlEpoch *domain) {
+	atomic_init(&domain->global, 1);
+	atomic_init(&domain->retired, NULL);
+	atomic_init(&domain->reclaiming, 0);
+
+	for (size_t i = 0; i < ARL_EPOCH_MAX_READERS; i++) {
+		atomic_init(&domain->readers[i].epoch, 0);
+		atomic_init(&domain->readers[i].used, 0);
+	}
+}
+
+
+ArlEpochReader* arl_epoch_register (ArlEpoch *domain) {
+	for (size_t i = 0; i < ARL_EPOCH_MAX_READERS; i++) {
+		ArlEpochReader *reader = &domain->readers[i];
+		int expected = 0;
+
+		if (atomic_compare_exchange_strong(&reader->used, &expected, 1)) {
+			atomic_store_explicit(&reader->epoch, 0, memory_order_relaxed);
+			return reader;
+		}
+	}
+	return NULL;
+}
+
+
+void arl_epoch_unregister (ArlEpochReader *reader) {
+	ARL_CHECK(atomic_load(&reader->epoch) == 0, "arl_epoch_unregister: reader is inside a read section");
+	atomic_store_explicit(&reader->used, 0, memory_order_release);
+}
+
+
+/**
+ * @brief Pushes a chain of retired entries (head..tail) back on the domain's stack.
+ */
+static void arl_epoch_push (ArlEpoch *domain, ArlRetired *head, ArlRetired *tail) {
+	ArlRetired *top = atomic_load_explicit(&domain->retired, memory_order_relaxed);
+	do {
+		tail->next = top;
+	} while (!atomic_compare_exchange_weak_explicit(&domain->retired, &top, head,
+				memory_order_release, memory_order_relaxed));
+}
+
+
+void arl_epoch_retire (ArlEpoch *domain, Armel *armel, ArlRetireFn fn, void *ctx) {
+	ArlRetired *entry = (ArlRetired*)malloc(sizeof(ArlRetired));
+	ARL_ASSERT_FATAL(entry != NULL, "arl_epoch_retire: out of memory");
+
+	entry->armel = armel;
+	entry->fn = fn;
+	entry->ctx = ctx;
+	// Readers that observe the advanced epoch started after the arena was unpublished
+	entry->epoch = atomic_fetch_add_explicit(&domain->global, 1, memory_order_seq_cst);
+
+	arl_epoch_push(domain, entry, entry);
+}
+
+
+/**
+ * @brief Reclaims what no reader can see; the caller holds the reclaiming guard.
+ */
+static size_t arl_epoch_reclaim_held (ArlEpoch *domain) {
+	ArlRetired *list = atomic_exchange_explicit(&domain->retired, NULL, memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	uint64_t oldest = UINT64_MAX;
+	for (size_t i = 0; i < ARL_EPOCH_MAX_READERS; i++) {
+		uint64_t epoch = atomic_load_explicit(&domain->readers[i].epoch, memory_order_acquire);
+		if (epoch != 0 && epoch < oldest) {
+			oldest = epoch;
+		}
+	}
+
+	ArlRetired *keep = NULL;
+	ArlRetired *keep_tail = NULL;
+	size_t count = 0;
+
+	while (list != NULL) {
+		ArlRetired *next = list->next;
+
+		if (list->epoch < oldest) {
+			if (list->fn != NULL) {
+				list->fn(list->armel, list->ctx);
+			} else {
+				arl_reset(list->armel);
+			}
+			free(list);
+			count++;
+		} else {
+			list->next = keep;
+			keep = list;
+			if (keep_tail == NULL) {
+				keep_tail = list;
+			}
+		}
+		list = next;
+	}
+
+	if (keep != NULL) {
+		arl_epoch_push(domain, keep, keep_tail);
+	}
+	return count;
+}
+
+
+size_t arl_epoch_reclaim (ArlEpoch *domain) {
+	if (atomic_exchange_explicit(&domain->reclaiming, 1, memory_order_acquire)) {
+		return 0;
+	}
+
+	size_t count = arl_epoch_reclaim_held(domain);
+	atomic_store_explicit(&domain->reclaiming, 0, memory_order_release);
+	return count;
+}
+
+
+void arl_epoch_drain (ArlEpoch *domain) {
+	for (;;) {
+		// An empty stack proves nothing while another thread reclaims: it may hold
+		// the detached list. Only an empty stack seen under the guard means done
+		if (atomic_exchange_explicit(&domain->reclaiming, 1, memory_order_acquire)) {
+			continue;
+		}
+
+		int done = atomic_load_explicit(&domain->retired, memory_order_acquire) == NULL;
+		if (!done) {
+			arl_epoch_reclaim_held(domain);
+		}
+		atomic_store_explicit(&domain->reclaiming, 0, memory_order_release);
+
+		if (done) {
+			return;
+		}
+	}
+}
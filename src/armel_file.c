@@ -0,0 +1,244 @@
+#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <Armel/armel_sys.h>
+#include <Armel/armel.h>
+#include <Armel/armel_file.h>
+
+#ifdef _WIN32
+
+	// Windows: every strategy reads the file through stdio
+	const void* arl_read_file_mode (Armel *armel, const char *path, size_t *len, ArlFileMode mode) {
+		(void)mode;
+
+		FILE *file = fopen(path, "rb");
+		if (file == NULL) {
+			return NULL;
+		}
+
+		uint8_t *data = NULL;
+		if (fseek(file, 0, SEEK_END) == 0) {
+			long size = ftell(file);
+			rewind(file);
+			data = size >= 0 ? (uint8_t*)arl_alloc(armel, (size_t)size + 1) : NULL;
+			if (data != NULL && fread(data, 1, (size_t)size, file) == (size_t)size) {
+				data[size] = '\0';
+				*len = (size_t)size;
+			} else {
+				data = NULL;
+			}
+		}
+
+		fclose(file);
+		return data;
+	}
+
+#else
+	#include <fcntl.h>
+	#include <errno.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+
+	/**
+	 * @brief Reads `size` bytes, or up to end of file, retrying short reads.
+	 *
+	 * @return Number of bytes read, or -1 on error
+	 */
+	static ssize_t arl_file_read_all (int fd, uint8_t *data, size_t size) {
+		size_t done = 0;
+
+		while (done < size) {
+			ssize_t got = read(fd, data + done, size - done);
+			if (got < 0 && errno == EINTR) {
+				continue;
+			}
+			if (got < 0) {
+				return -1;
+			}
+			if (got == 0) {
+				break;
+			}
+			done += (size_t)got;
+		}
+		return (ssize_t)done;
+	}
+
+	static const void* arl_file_read (Armel *armel, int fd, size_t size, size_t *len) {
+		uint8_t *data = (uint8_t*)arl_alloc(armel, size + 1);
+		if (data == NULL) {
+			return NULL;
+		}
+
+		ssize_t got = arl_file_read_all(fd, data, size);
+		if (got < 0) {
+			return NULL;
+		}
+
+		data[got] = '\0';
+		*len = (size_t)got;
+		return data;
+	}
+
+	/**
+	 * @brief Reads until end of file when the size is unknown (pipes, procfs, sysfs).
+	 *
+	 * The buffer is the arena's last allocation: it grows in place while the arena
+	 * has room, and moves to a buffer twice as large otherwise.
+	 */
+	static const void* arl_file_read_stream (Armel *armel, int fd, size_t *len) {
+		size_t capacity = 4096;
+		size_t done = 0;
+		uint8_t *data = (uint8_t*)arl_alloc(armel, capacity + 1);
+
+		while (data != NULL) {
+			ssize_t got = read(fd, data + done, capacity - done);
+			if (got < 0 && errno == EINTR) {
+				continue;
+			}
+			if (got < 0) {
+				return NULL;
+			}
+			if (got == 0) {
+				data[done] = '\0';
+				*len = done;
+				return data;
+			}
+
+			done += (size_t)got;
+			if (done < capacity) {
+				continue;
+			}
+
+			if ((uint8_t*)armel->cursor == data + capacity + 1 && arl_remaining(armel) >= capacity) {
+				armel->cursor = data + capacity * 2 + 1;
+			} else {
+				uint8_t *larger = (uint8_t*)arl_alloc(armel, capacity * 2 + 1);
+				if (larger != NULL) {
+					memcpy(larger, data, done);
+				}
+				data = larger;
+			}
+			capacity *= 2;
+		}
+		return NULL;
+	}
+
+	/**
+	 * @struct ArlFileMapping
+	 * @brief Mapping unmapped by an arena finalizer.
+	 */
+	typedef struct {
+		void *ptr;
+		size_t size;
+	} ArlFileMapping;
+
+	static void arl_file_unmap (void *ctx) {
+		ArlFileMapping *mapping = (ArlFileMapping*)ctx;
+		munmap(mapping->ptr, mapping->size);
+	}
+
+	static const void* arl_file_map (Armel *armel, int fd, size_t size, size_t *len) {
+		int flags = MAP_PRIVATE;
+	#if defined(MAP_POPULATE)
+		flags |= MAP_POPULATE;
+	#endif
+
+		void *ptr = mmap(NULL, size, PROT_READ, flags, fd, 0);
+		if (ptr == MAP_FAILED) {
+			return NULL;
+		}
+		madvise(ptr, size, MADV_SEQUENTIAL);
+
+		// The record describing the mapping lives in the arena, below its finalizer
+		ArlFileMapping *mapping = arl_make(armel, ArlFileMapping);
+		if (mapping == NULL || !arl_defer(armel, arl_file_unmap, mapping)) {
+			munmap(ptr, size);
+			return NULL;
+		}
+		mapping->ptr = ptr;
+		mapping->size = size;
+
+		*len = size;
+		return ptr;
+	}
+
+	static const void* arl_file_direct (Armel *armel, const char *path, size_t size, size_t *len) {
+	#if defined(O_DIRECT)
+		int fd = open(path, O_RDONLY | O_DIRECT);
+		if (fd < 0) {
+			return NULL;
+		}
+
+		// O_DIRECT transfers whole, aligned pages
+		size_t page = arl_sys_page_size();
+		size_t padded = arl_align_up(size ? size : 1, page);
+		size_t slack = page > armel->alignment ? page - armel->alignment : 0;
+		uint8_t *raw = (uint8_t*)arl_alloc(armel, padded + slack);
+		uint8_t *data = raw ? (uint8_t*)arl_align_up((uintptr_t)raw, page) : NULL;
+
+		ssize_t got = data ? arl_file_read_all(fd, data, padded) : -1;
+		close(fd);
+
+		if (got < 0) {
+			return NULL;
+		}
+		*len = (size_t)got < size ? (size_t)got : size;
+		return data;
+	#else
+		(void)armel; (void)path; (void)size; (void)len;
+		return NULL;
+	#endif
+	}
+
+	const void* arl_read_file_mode (Armel *armel, const char *path, size_t *len, ArlFileMode mode) {
+		int fd = open(path, O_RDONLY);
+		if (fd < 0) {
+			return NULL;
+		}
+
+		struct stat info;
+		if (fstat(fd, &info) != 0) {
+			close(fd);
+			return NULL;
+		}
+
+		size_t size = (size_t)info.st_size;
+		if (mode == ARL_FILE_AUTO) {
+			mode = size >= ARL_FILE_MAP_THRESHOLD ? ARL_FILE_MAP : ARL_FILE_READ;
+		}
+
+		// Pipes and procfs/sysfs files report no size (or 0): read them to the end
+		if (!S_ISREG(info.st_mode) || size == 0) {
+			const void *data = arl_file_read_stream(armel, fd, len);
+			close(fd);
+			return data;
+		}
+
+		const void *data = NULL;
+		if (mode == ARL_FILE_DIRECT) {
+			data = arl_file_direct(armel, path, size, len);
+		} else if (mode == ARL_FILE_MAP) {
+			data = arl_file_map(armel, fd, size, len);
+		}
+
+		// File systems refusing O_DIRECT or mmap are read
+		if (data == NULL) {
+			data = arl_file_read(armel, fd, size, len);
+		}
+
+		close(fd);
+		return data;
+	}
+
+#endif
+
+
+const void* arl_read_file (Armel *armel, const char *path, size_t *len) {
+	return arl_read_file_mode(armel, path, len, ARL_FILE_AUTO);
+}
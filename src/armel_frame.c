@@ -0,0 +1,103 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_frame.h>
+
+/**
+ * @brief Creates (or re-creates) one arena of the ring with the ring's settings.
+ */
+static void arl_frame_arena (ArlFrameRing *ring, Armel *armel, size_t size) {
+	arl_new_custom(armel, size, ring->alignment, (uint8_t)(ring->flags & ~ARL_FRAME_ADAPTIVE));
+
+	if (!(ring->flags & ARL_SOFTFAIL)) {
+		arl_set_overflow_handler(armel, arl_overflow_grow, NULL);
+	}
+}
+
+
+void arl_frame_new (ArlFrameRing *ring, size_t count, size_t size, uint8_t flags) {
+	ARL_CHECK(count >= 1 && count <= ARL_FRAME_MAX, "arl_frame_new: invalid number of frames");
+
+	memset(ring, 0, sizeof(*ring));
+	ring->count = count;
+	ring->min_size = size;
+	ring->alignment = ARL_ALIGN;
+	ring->flags = flags;
+
+	for (size_t i = 0; i < count; i++) {
+		arl_frame_arena(ring, &ring->arenas[i], size);
+	}
+}
+
+
+void arl_frame_free (ArlFrameRing *ring) {
+	for (size_t i = 0; i < ring->count; i++) {
+		arl_free(&ring->arenas[i]);
+	}
+	ring->count = 0;
+}
+
+
+/**
+ * @brief Picks a new capacity for a recycled arena from recent frame peaks.
+ * @return The new capacity, or 0 to keep the arena as is.
+ */
+static size_t arl_frame_target (ArlFrameRing *ring, Armel *armel) {
+	size_t capacity = (uintptr_t)armel->end - (uintptr_t)armel->base;
+	size_t recent = 0;
+
+	for (size_t i = 0; i < ARL_FRAME_HISTORY; i++) {
+		if (ring->history[i] > recent) {
+			recent = ring->history[i];
+		}
+	}
+
+	size_t target = arl_align_up(recent + recent / 4, 4 * ARL_KB);
+	if (target < ring->min_size) {
+		target = ring->min_size;
+	}
+
+	if (target > capacity || target < capacity / 4) {
+		return target;
+	}
+	return 0;
+}
+
+
+Armel* arl_frame_advance (ArlFrameRing *ring) {
+	size_t used = arl_used(&ring->arenas[ring->current]);
+
+	ring->history[ring->frame % ARL_FRAME_HISTORY] = used;
+	ring->last_peak = used;
+	if (used > ring->max_peak) {
+		ring->max_peak = used;
+	}
+	ring->frame++;
+
+	ring->current = (ring->current + 1) % ring->count;
+	Armel *armel = &ring->arenas[ring->current];
+
+	arl_reset(armel);
+
+	if (ring->flags & ARL_FRAME_ADAPTIVE) {
+		size_t target = arl_frame_target(ring, armel);
+		if (target != 0) {
+			arl_free(armel);
+			arl_frame_arena(ring, armel, target);
+		}
+	}
+
+	return armel;
+}
+
+
+void* arl_frame_promote (ArlFrameRing *ring, const void *ptr, size_t size) {
+	void *copy = arl_alloc(arl_frame_current(ring), size);
+
+	if (copy != NULL) {
+		memcpy(copy, ptr, size);
+	}
+	return copy;
+}
@@ -0,0 +1,158 @@
+#ifndef _POSIX_C_SOURCE
+	#define _POSIX_C_SOURCE 200809L // clock_gettime
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_gc.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+// Set in a header's type word once the object has been copied
+#define ARL_GC_FORWARDED ((uintptr_t)1)
+
+static uint64_t arl_gc_now_ns (void) {
+#ifdef _WIN32
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+
+void arl_gc_new (ArlGc *gc, size_t size) {
+	memset(gc, 0, sizeof(*gc));
+
+	// A full semi-space returns NULL instead of growing: both must stay one block
+	arl_new_custom(&gc->spaces[0], size, sizeof(ArlGcHeader), ARL_SOFTFAIL);
+	arl_new_custom(&gc->spaces[1], size, sizeof(ArlGcHeader), ARL_SOFTFAIL);
+}
+
+
+void arl_gc_free (ArlGc *gc) {
+	arl_free(&gc->spaces[0]);
+	arl_free(&gc->spaces[1]);
+	gc->root_count = 0;
+}
+
+
+static void* arl_gc_place (Armel *space, uintptr_t type, size_t size) {
+	if (size > SIZE_MAX - sizeof(ArlGcHeader)) {
+		return NULL;   // the header would wrap the request, as if the space were full
+	}
+
+	ArlGcHeader *header = (ArlGcHeader*)arl_alloc(space, sizeof(ArlGcHeader) + size);
+
+	if (header == NULL) {
+		return NULL;
+	}
+	header->type = type;
+	header->size = size;
+	return header + 1;
+}
+
+
+void* arl_gc_alloc (ArlGc *gc, const ArlGcType *type, size_t size) {
+	return arl_gc_place(&gc->spaces[gc->current], (uintptr_t)type, size ? size : type->size);
+}
+
+
+int arl_gc_root (ArlGc *gc, void *root) {
+	if (gc->root_count == ARL_GC_ROOTS) {
+		return 0;
+	}
+	gc->roots[gc->root_count++] = (void**)root;
+	return 1;
+}
+
+
+void arl_gc_unroot (ArlGc *gc, void *root) {
+	for (size_t i = 0; i < gc->root_count; i++) {
+		if (gc->roots[i] == (void**)root) {
+			gc->roots[i] = gc->roots[--gc->root_count];
+			return;
+		}
+	}
+}
+
+
+void arl_gc_relocate (ArlGc *gc, void *field) {
+	void **slot = (void**)field;
+	Armel *from = &gc->spaces[gc->current];
+	uint8_t *object = (uint8_t*)*slot;
+
+	if (object < (uint8_t*)from->base || object >= (uint8_t*)from->cursor) {
+		return;
+	}
+
+	ArlGcHeader *header = (ArlGcHeader*)object - 1;
+	Armel *to = &gc->spaces[!gc->current];
+	uintptr_t word = header->type;
+
+	// An interior pointer reads object data as a header: catch what does not look like one
+	if (word & ARL_GC_FORWARDED) {
+		uint8_t *copy = (uint8_t*)(word & ~ARL_GC_FORWARDED);
+		ARL_CHECK(copy > (uint8_t*)to->base && copy < (uint8_t*)to->cursor,
+			"arl_gc_relocate: field does not point to the start of an object");
+		*slot = copy;
+		return;
+	}
+	ARL_CHECK(word != 0 && (word & (_Alignof(ArlGcType) - 1)) == 0
+		&& (word < (uintptr_t)from->base || word >= (uintptr_t)from->end)
+		&& (word < (uintptr_t)to->base || word >= (uintptr_t)to->end)
+		&& header->size <= (size_t)((uint8_t*)from->cursor - object),
+		"arl_gc_relocate: field does not point to the start of an object");
+
+	// The to-space is as large as the from-space: the copy always fits
+	void *copy = arl_gc_place(to, header->type, header->size);
+	memcpy(copy, object, header->size);
+	header->type = (uintptr_t)copy | ARL_GC_FORWARDED;
+	gc->stats.objects++;
+	*slot = copy;
+}
+
+
+ArlGcStats arl_collect (ArlGc *gc) {
+	uint64_t start = arl_gc_now_ns();
+	Armel *from = &gc->spaces[gc->current];
+	Armel *to = &gc->spaces[!gc->current];
+
+	memset(&gc->stats, 0, sizeof(gc->stats));
+	arl_reset(to);
+
+	for (size_t i = 0; i < gc->root_count; i++) {
+		arl_gc_relocate(gc, gc->roots[i]);
+	}
+
+	// Cheney scan: the copies not traced yet sit between scan and the to-space cursor
+	uint8_t *scan = (uint8_t*)to->base;
+	while (scan < (uint8_t*)to->cursor) {
+		ArlGcHeader *header = (ArlGcHeader*)scan;
+		const ArlGcType *type = (const ArlGcType*)header->type;
+
+		if (type->trace != NULL) {
+			type->trace(gc, header + 1);
+		}
+		scan = (uint8_t*)arl_align_up((uintptr_t)(header + 1) + header->size, to->alignment);
+	}
+
+	gc->stats.copied = arl_used(to);
+	gc->stats.reclaimed = arl_used(from) - arl_used(to);
+	arl_reset(from);
+	gc->current = !gc->current;
+	gc->collections++;
+
+	gc->stats.pause_ns = arl_gc_now_ns() - start;
+	return gc->stats;
+}
@@ -0,0 +1,26 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_handle.h>
+
+int arl_handle_pool_new (ArlHandlePool *pool, Armel *armel, size_t size, uint32_t capacity) {
+	ARL_CHECK(capacity > 0 && (ArlHandle)(capacity - 1) <= ARL_HANDLE_INDEX_MASK,
+		"arl_handle_pool_new: capacity exceeds the handle index range");
+
+	memset(pool, 0, sizeof(*pool));
+	pool->size = arl_align_up(size ? size : 1, armel->alignment);
+	pool->items = (uint8_t*)arl_alloc(armel, pool->size * capacity);
+	pool->owners = arl_array(armel, uint32_t, capacity);
+	pool->slots = arl_array(armel, ArlHandleSlot, capacity);
+
+	if (pool->items == NULL || pool->owners == NULL || pool->slots == NULL) {
+		return 0;
+	}
+
+	pool->capacity = capacity;
+	pool->free = UINT32_MAX;
+	return 1;
+}
+
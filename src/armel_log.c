@@ -0,0 +1,105 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <Armel/armel_sys.h>
+#include <Armel/armel.h>
+#include <Armel/armel_log.h>
+
+void arl_log_new (ArlLog *log, size_t capacity) {
+	size_t size = arl_align_up(capacity, ARL_ALIGN);
+
+	// Fresh system memory is zeroed, and each reset clears the used part again:
+	// every header a producer lands on starts in the reserved state
+	log->buffer = (uint8_t*)arl_sys_alloc(size);
+	log->capacity = size;
+	log->read = 0;
+	atomic_init(&log->cursor, 0);
+}
+
+
+void arl_log_free (ArlLog *log) {
+	arl_sys_free(log->buffer, log->capacity);
+	log->buffer = NULL;
+	log->capacity = 0;
+}
+
+
+void* arl_log_reserve (ArlLog *log, size_t size) {
+	ARL_CHECK(size <= UINT32_MAX, "arl_log_reserve: record too large");
+
+	size_t record = arl_align_up(ARL_LOG_HEADER + size, ARL_ALIGN);
+	// Acquire: pairs with the consumer's reset, so its clearing happens before our writes
+	size_t pos = atomic_fetch_add_explicit(&log->cursor, record, memory_order_acquire);
+
+	if (pos + record > log->capacity) {
+		// First producer to run past the end closes the log for the consumer
+		if (pos < log->capacity) {
+			ArlLogHeader *end = (ArlLogHeader*)(log->buffer + pos);
+			atomic_store_explicit(&end->state, ARL_LOG_END, memory_order_release);
+		}
+		return NULL;
+	}
+
+	ArlLogHeader *header = (ArlLogHeader*)(log->buffer + pos);
+	header->size = (uint32_t)size;
+	return log->buffer + pos + ARL_LOG_HEADER;
+}
+
+
+void* arl_log_next (ArlLog *log, size_t *size) {
+	// Nothing past the published cursor was reserved this round: never read it
+	size_t cursor = atomic_load_explicit(&log->cursor, memory_order_acquire);
+	if (log->read >= cursor || log->read >= log->capacity) {
+		return NULL;
+	}
+
+	ArlLogHeader *header = (ArlLogHeader*)(log->buffer + log->read);
+	uint32_t state = atomic_load_explicit(&header->state, memory_order_acquire);
+
+	if (state == ARL_LOG_END) {
+		log->read = log->capacity;
+		return NULL;
+	}
+	if (state != ARL_LOG_COMMITTED) {
+		return NULL;
+	}
+
+	if (size != NULL) {
+		*size = header->size;
+	}
+	return log->buffer + log->read + ARL_LOG_HEADER;
+}
+
+
+void arl_log_consume (ArlLog *log) {
+	ArlLogHeader *header = (ArlLogHeader*)(log->buffer + log->read);
+
+	log->read += arl_align_up(ARL_LOG_HEADER + header->size, ARL_ALIGN);
+}
+
+
+int arl_log_reset (ArlLog *log) {
+	size_t cursor = atomic_load_explicit(&log->cursor, memory_order_acquire);
+
+	int drained = (cursor == log->read) || (cursor >= log->capacity && log->read >= log->capacity);
+	if (!drained) {
+		return 0;
+	}
+
+	// Headers of the next round can land on this round's payload bytes, so the
+	// whole used part is cleared, not just the old headers. A producer reserving
+	// in the meantime writes at or past `cursor`, outside the cleared range
+	memset(log->buffer, 0, cursor < log->capacity ? cursor : log->capacity);
+
+	// Fails if a producer reserved in the meantime. Release: producers that
+	// reserve after the reset see the cleared memory
+	if (!atomic_compare_exchange_strong_explicit(&log->cursor, &cursor, 0,
+			memory_order_acq_rel, memory_order_relaxed)) {
+		return 0;
+	}
+
+	log->read = 0;
+	return 1;
+}
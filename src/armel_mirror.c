@@ -0,0 +1,36 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include <Armel/armel_sys.h>
+#include <Armel/armel.h>
+#include <Armel/armel_mirror.h>
+
+int arl_mirror_new (ArlMirror *ring, size_t capacity) {
+	size_t size = arl_sys_page_size();
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	ring->buffer = (uint8_t*)arl_sys_alloc_mirror(size);
+	if (ring->buffer == NULL) {
+		size = 0;
+	}
+	ring->capacity = size;
+	ring->mask = size - 1;
+	ring->tail_seen = 0;
+	ring->head_seen = 0;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	return ring->buffer != NULL;
+}
+
+
+void arl_mirror_free (ArlMirror *ring) {
+	if (ring->buffer != NULL) {
+		arl_sys_free_mirror(ring->buffer, ring->capacity);
+	}
+	ring->buffer = NULL;
+	ring->capacity = 0;
+	ring->mask = 0;
+}
@@ -0,0 +1,186 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_mpsc.h>
+
+void arl_mpsc_new (ArlMpsc *queue) {
+	atomic_init(&queue->stub.next, NULL);
+	queue->stub.producer = NULL;
+	atomic_init(&queue->head, &queue->stub);
+	queue->tail = &queue->stub;
+	atomic_init(&queue->count, 0);
+	atomic_init(&queue->flushing, 0);
+
+	for (size_t i = 0; i < ARL_MPSC_MAX_PRODUCERS; i++) {
+		atomic_init(&queue->producers[i], NULL);
+	}
+}
+
+
+void arl_mpsc_producer_new (ArlMpsc *queue, ArlMpscProducer *producer, size_t size) {
+	for (int i = 0; i < 2; i++) {
+		arl_new(&producer->arenas[i], size);
+		arl_set_overflow_handler(&producer->arenas[i], arl_overflow_grow, NULL);
+		producer->sent[i] = 0;
+		producer->pending[i] = 0;
+		atomic_init(&producer->acked[i], 0);
+	}
+	producer->current = 0;
+
+	// Claim the first free slot (freed producers give theirs back), publishing
+	// the initialized producer to arl_mpsc_flush()
+	size_t index = 0;
+	for (; index < ARL_MPSC_MAX_PRODUCERS; index++) {
+		ArlMpscProducer *expected = NULL;
+		if (atomic_compare_exchange_strong_explicit(&queue->producers[index], &expected, producer,
+				memory_order_release, memory_order_relaxed)) {
+			break;
+		}
+	}
+	ARL_CHECK(index < ARL_MPSC_MAX_PRODUCERS, "arl_mpsc_producer_new: too many live producers");
+	producer->slot = index;
+
+	// Flushes scan the slots below the high-water mark
+	size_t count = atomic_load(&queue->count);
+	while (count <= index && !atomic_compare_exchange_weak(&queue->count, &count, index + 1)) {}
+}
+
+
+void arl_mpsc_producer_free (ArlMpsc *queue, ArlMpscProducer *producer) {
+	atomic_store(&queue->producers[producer->slot], NULL);
+
+	// A flush in progress may have loaded the producer before it was unregistered
+	size_t flushing = atomic_load(&queue->flushing);
+	if (flushing & 1) {
+		while (atomic_load(&queue->flushing) == flushing) {}
+	}
+
+	arl_free(&producer->arenas[0]);
+	arl_free(&producer->arenas[1]);
+}
+
+
+/**
+ * @brief Resets an arena of the producer if all of its messages were acknowledged.
+ * @return 1 if the arena is empty and ready for reuse.
+ */
+static int arl_mpsc_recycle (ArlMpscProducer *producer, uint32_t half) {
+	if (producer->sent[half] == 0) {
+		return 1;
+	}
+	if (atomic_load_explicit(&producer->acked[half], memory_order_acquire) != producer->sent[half]) {
+		return 0;
+	}
+
+	// The consumer no longer touches this arena: its counters can restart from zero
+	arl_reset(&producer->arenas[half]);
+	producer->sent[half] = 0;
+	atomic_store_explicit(&producer->acked[half], 0, memory_order_relaxed);
+	return 1;
+}
+
+
+void* arl_mpsc_alloc (ArlMpscProducer *producer, size_t size) {
+	uint32_t half = producer->current;
+
+	arl_mpsc_recycle(producer, half);
+	if (producer->sent[half] >= ARL_MPSC_SWITCH && arl_mpsc_recycle(producer, half ^ 1)) {
+		half ^= 1;
+		producer->current = half;
+	}
+
+	ARL_CHECK(size <= UINT32_MAX, "arl_mpsc_alloc: payload larger than UINT32_MAX bytes");
+
+	ArlMpscNode *node = (ArlMpscNode*)arl_alloc(&producer->arenas[half], ARL_MPSC_NODE + size);
+	node->producer = producer;
+	node->half = half;
+	node->size = (uint32_t)size;
+	producer->sent[half]++;
+	return (uint8_t*)node + ARL_MPSC_NODE;
+}
+
+
+/**
+ * @brief Links a node at the head of the queue (wait-free, any thread).
+ */
+static void arl_mpsc_push (ArlMpsc *queue, ArlMpscNode *node) {
+	atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+	ArlMpscNode *prev = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+	atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+
+void arl_mpsc_send (ArlMpsc *queue, void *payload) {
+	arl_mpsc_push(queue, (ArlMpscNode*)((uint8_t*)payload - ARL_MPSC_NODE));
+}
+
+
+void* arl_mpsc_pop (ArlMpsc *queue, size_t *size) {
+	ArlMpscNode *tail = queue->tail;
+	ArlMpscNode *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+	if (tail == &queue->stub) {
+		if (next == NULL) {
+			return NULL;
+		}
+		queue->tail = next;
+		tail = next;
+		next = atomic_load_explicit(&next->next, memory_order_acquire);
+	}
+
+	if (next == NULL) {
+		if (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) {
+			return NULL; // a producer is between its exchange and its link
+		}
+		// Last node: queue the stub behind it so the node can be handed out
+		arl_mpsc_push(queue, &queue->stub);
+		next = atomic_load_explicit(&tail->next, memory_order_acquire);
+		if (next == NULL) {
+			return NULL;
+		}
+	}
+
+	queue->tail = next;
+	if (size != NULL) {
+		*size = tail->size;
+	}
+	return (uint8_t*)tail + ARL_MPSC_NODE;
+}
+
+
+void arl_mpsc_done (ArlMpsc *queue, void *payload) {
+	(void)queue;
+	ArlMpscNode *node = (ArlMpscNode*)((uint8_t*)payload - ARL_MPSC_NODE);
+	ArlMpscProducer *producer = node->producer;
+	uint32_t half = node->half;
+
+	if (++producer->pending[half] >= ARL_MPSC_BATCH) {
+		atomic_fetch_add_explicit(&producer->acked[half], producer->pending[half], memory_order_release);
+		producer->pending[half] = 0;
+	}
+}
+
+
+void arl_mpsc_flush (ArlMpsc *queue) {
+	size_t count = atomic_load_explicit(&queue->count, memory_order_acquire);
+
+	// Odd while producers are read: arl_mpsc_producer_free() waits for the end
+	atomic_fetch_add(&queue->flushing, 1);
+
+	for (size_t i = 0; i < count && i < ARL_MPSC_MAX_PRODUCERS; i++) {
+		ArlMpscProducer *producer = atomic_load(&queue->producers[i]);
+		if (producer == NULL) {
+			continue;
+		}
+		for (int half = 0; half < 2; half++) {
+			if (producer->pending[half] != 0) {
+				atomic_fetch_add_explicit(&producer->acked[half], producer->pending[half], memory_order_release);
+				producer->pending[half] = 0;
+			}
+		}
+	}
+
+	atomic_fetch_add_explicit(&queue->flushing, 1, memory_order_release);
+}
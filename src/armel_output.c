@@ -0,0 +1,201 @@
+#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE
+#endif
+
+#ifndef _WIN32
+
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_output.h>
+
+#ifndef IOV_MAX
+	#define IOV_MAX 1024
+#endif
+
+void arl_output_init (ArlOutput *out) {
+	out->count = 0;
+	out->first = 0;
+	out->bytes = 0;
+	out->pin = NULL;
+}
+
+
+int arl_output_add (ArlOutput *out, const void *ptr, size_t len) {
+	if (len == 0) {
+		return 1;
+	}
+
+	if (out->count > out->first) {
+		struct iovec *last = &out->iov[out->count - 1];
+		if ((const uint8_t*)last->iov_base + last->iov_len == (const uint8_t*)ptr) {
+			last->iov_len += len;
+			out->bytes += len;
+			return 1;
+		}
+	}
+
+	if (out->count == ARL_OUTPUT_IOV) {
+		return 0;
+	}
+
+	out->iov[out->count].iov_base = (void*)ptr;
+	out->iov[out->count].iov_len = len;
+	out->count++;
+	out->bytes += len;
+	return 1;
+}
+
+
+/**
+ * @brief Skips `done` bytes of the queue, after a partial write.
+ */
+static void arl_output_advance (ArlOutput *out, size_t done) {
+	out->bytes -= done;
+
+	while (done > 0) {
+		struct iovec *iov = &out->iov[out->first];
+
+		if (done < iov->iov_len) {
+			iov->iov_base = (uint8_t*)iov->iov_base + done;
+			iov->iov_len -= done;
+			return;
+		}
+		done -= iov->iov_len;
+		out->first++;
+	}
+}
+
+
+ssize_t arl_output_write (ArlOutput *out, int fd) {
+	ssize_t total = 0;
+
+	while (out->first < out->count) {
+		int count = out->count - out->first;
+		ssize_t done = writev(fd, &out->iov[out->first], count < IOV_MAX ? count : IOV_MAX);
+
+		if (done < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return total > 0 ? total : -1;
+		}
+		arl_output_advance(out, (size_t)done);
+		total += done;
+	}
+	return total;
+}
+
+
+static int arl_output_pipe_empty (int pipe) {
+	int pending = 0;
+	return ioctl(pipe, FIONREAD, &pending) == 0 && pending == 0;
+}
+
+
+/**
+ * @brief Deactivates a pin and unlinks it from its output.
+ */
+static void arl_output_unpin (ArlOutputPin *pin) {
+	pin->active = 0;
+	if (pin->owner != NULL) {
+		*pin->owner = pin->next;
+		if (pin->next != NULL) {
+			pin->next->owner = pin->owner;
+		}
+		pin->owner = NULL;
+		pin->next = NULL;
+	}
+}
+
+
+static void arl_output_check_pin (void *ctx) {
+	ArlOutputPin *pin = (ArlOutputPin*)ctx;
+
+	// Freeing pages the kernel still reads is memory corruption: never compiled out
+	ARL_ASSERT_FATAL(!pin->active || arl_output_pipe_empty(pin->pipe),
+		"arl_output: arena released while a pipe still references spliced pages (see arl_output_drained)");
+
+	// The pin goes away with the arena: the output must not keep pointing at it
+	arl_output_unpin(pin);
+}
+
+
+ssize_t arl_output_splice (ArlOutput *out, Armel *armel, int pipe) {
+#if defined(__linux__)
+	if (out->first == out->count) {
+		return 0;
+	}
+
+	// One pin per call, registered after the buffers it covers: a reset or a
+	// rewind of `armel` that frees them runs its check, whatever pin came before
+	ArlOutputPin *pin = arl_make(armel, ArlOutputPin);
+	if (pin == NULL || !arl_defer(armel, arl_output_check_pin, pin)) {
+		errno = ENOMEM;
+		return -1;
+	}
+	pin->pipe = pipe;
+	pin->active = 1;
+	pin->next = out->pin;
+	pin->owner = &out->pin;
+	if (out->pin != NULL) {
+		out->pin->owner = &pin->next;
+	}
+	out->pin = pin;
+
+	ssize_t total = 0;
+	while (out->first < out->count) {
+		int count = out->count - out->first;
+		ssize_t done = vmsplice(pipe, &out->iov[out->first], (unsigned long)(count < IOV_MAX ? count : IOV_MAX), 0);
+
+		if (done < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (total == 0) {
+				// Nothing reached the pipe: nothing to pin
+				arl_output_unpin(pin);
+				return -1;
+			}
+			return total;
+		}
+		arl_output_advance(out, (size_t)done);
+		total += done;
+	}
+	return total;
+#else
+	(void)out; (void)armel; (void)pipe;
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+
+int arl_output_drained (ArlOutput *out) {
+	ArlOutputPin *pin = out->pin;
+
+	while (pin != NULL) {
+		ArlOutputPin *next = pin->next;
+		if (arl_output_pipe_empty(pin->pipe)) {
+			arl_output_unpin(pin);
+		}
+		pin = next;
+	}
+	return out->pin == NULL;
+}
+
+
+void arl_output_release (ArlOutput *out) {
+	while (out->pin != NULL) {
+		arl_output_unpin(out->pin);
+	}
+}
+
+#endif
@@ -0,0 +1,48 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_pool.h>
+
+void arl_pool_new (ArlPool *pool, Armel *armel, size_t size) {
+	if (size < sizeof(ArlPoolSlot)) {
+		size = sizeof(ArlPoolSlot);
+	}
+
+	pool->armel = armel;
+	pool->size = arl_align_up(size, armel->alignment);
+	pool->free = NULL;
+	atomic_init(&pool->remote, NULL);
+}
+
+
+void* arl_pool_refill (ArlPool *pool) {
+	// Take the whole inbox at once: remote frees are amortized over the batch
+	if (atomic_load_explicit(&pool->remote, memory_order_relaxed) != NULL) {
+		ArlPoolSlot *batch = atomic_exchange_explicit(&pool->remote, NULL, memory_order_acquire);
+
+		pool->free = batch->next;
+		return batch;
+	}
+
+	return arl_alloc(pool->armel, pool->size);
+}
+
+
+void arl_pool_free_remote (ArlPool *pool, void *ptr) {
+	ArlPoolSlot *slot = (ArlPoolSlot*)ptr;
+	ArlPoolSlot *top = atomic_load_explicit(&pool->remote, memory_order_relaxed);
+
+	// Only the owner pops, and it takes the whole stack: no ABA problem
+	do {
+		slot->next = top;
+	} while (!atomic_compare_exchange_weak_explicit(&pool->remote, &top, slot,
+				memory_order_release, memory_order_relaxed));
+}
+
+
+void arl_pool_reset (ArlPool *pool) {
+	pool->free = NULL;
+	atomic_store_explicit(&pool->remote, NULL, memory_order_relaxed);
+}
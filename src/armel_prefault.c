@@ -0,0 +1,212 @@
+#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE // sched_setaffinity, MADV_POPULATE_WRITE
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_prefault.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+	#include <sched.h>
+#endif
+
+// Every page size in use is a multiple of this
+#define ARL_PREFAULT_STRIDE 4096
+
+/**
+ * @struct ArlPrefaultSlice
+ * @brief Work of one thread.
+ */
+typedef struct {
+	uint8_t *ptr;
+	size_t size;
+	ArlPrefaultMode mode;
+	int node;
+} ArlPrefaultSlice;
+
+
+#if defined(__linux__)
+	/**
+	 * @brief Pins the calling thread to the CPUs of a NUMA node (from sysfs).
+	 */
+	static void arl_prefault_pin (int node) {
+		char path[64];
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+
+		FILE *file = fopen(path, "r");
+		if (file == NULL) {
+			return;
+		}
+
+		// cpulist: "0-15,32-47"
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		int first, last;
+		while (fscanf(file, "%d", &first) == 1) {
+			last = first;
+			int next = fgetc(file);
+			if (next == '-' && fscanf(file, "%d", &last) == 1) {
+				next = fgetc(file);
+			}
+			for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+				CPU_SET(cpu, &set);
+			}
+			if (next != ',') {
+				break;
+			}
+		}
+		fclose(file);
+
+		if (CPU_COUNT(&set) > 0) {
+			sched_setaffinity(0, sizeof(set), &set);
+		}
+	}
+#else
+	// No portable NUMA placement elsewhere: the node is ignored
+	static void arl_prefault_pin (int node) {
+		(void)node;
+	}
+#endif
+
+
+static void arl_prefault_run (ArlPrefaultSlice *slice) {
+	if (slice->node != ARL_NUMA_ANY) {
+		arl_prefault_pin(slice->node);
+	}
+
+	if (slice->mode == ARL_PREFAULT_ZERO) {
+		memset(slice->ptr, 0, slice->size);
+		return;
+	}
+
+#if defined(MADV_POPULATE_WRITE)
+	// Linux 5.14+: the kernel faults the whole slice in one call
+	if (madvise(slice->ptr, slice->size, MADV_POPULATE_WRITE) == 0) {
+		return;
+	}
+#endif
+
+	// One write per page commits it without changing its content
+	volatile uint8_t *page = slice->ptr;
+	volatile uint8_t *end = slice->ptr + slice->size;
+	for (; page < end; page += ARL_PREFAULT_STRIDE) {
+		*page = *page;
+	}
+}
+
+
+#ifdef _WIN32
+	typedef HANDLE ArlPrefaultThread;
+
+	static DWORD WINAPI arl_prefault_main (LPVOID arg) {
+		arl_prefault_run((ArlPrefaultSlice*)arg);
+		return 0;
+	}
+
+	static int arl_prefault_start (ArlPrefaultThread *thread, ArlPrefaultSlice *slice) {
+		*thread = CreateThread(NULL, 0, arl_prefault_main, slice, 0, NULL);
+		return *thread != NULL;
+	}
+
+	static void arl_prefault_join (ArlPrefaultThread thread) {
+		WaitForSingleObject(thread, INFINITE);
+		CloseHandle(thread);
+	}
+
+	static int arl_prefault_cpus (void) {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return (int)info.dwNumberOfProcessors;
+	}
+#else
+	typedef pthread_t ArlPrefaultThread;
+
+	static void* arl_prefault_main (void *arg) {
+		arl_prefault_run((ArlPrefaultSlice*)arg);
+		return NULL;
+	}
+
+	static int arl_prefault_start (ArlPrefaultThread *thread, ArlPrefaultSlice *slice) {
+		return pthread_create(thread, NULL, arl_prefault_main, slice) == 0;
+	}
+
+	static void arl_prefault_join (ArlPrefaultThread thread) {
+		pthread_join(thread, NULL);
+	}
+
+	static int arl_prefault_cpus (void) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		return cpus > 0 ? (int)cpus : 1;
+	}
+#endif
+
+
+int arl_prefault (void *ptr, size_t size, ArlPrefaultMode mode, int threads, int node) {
+	if (ptr == NULL || size == 0) {
+		return 0;
+	}
+
+	size_t count = threads > 0 ? (size_t)threads : (size_t)arl_prefault_cpus();
+	size_t most = size / ARL_PREFAULT_SLICE;
+	if (count > most) count = most;
+	if (count > ARL_PREFAULT_THREADS) count = ARL_PREFAULT_THREADS;
+	if (count == 0) count = 1;
+
+	// Small range, nothing to pin: no thread at all
+	ArlPrefaultSlice slices[ARL_PREFAULT_THREADS];
+	if (count == 1 && node == ARL_NUMA_ANY) {
+		slices[0] = (ArlPrefaultSlice){ (uint8_t*)ptr, size, mode, node };
+		arl_prefault_run(&slices[0]);
+		return 1;
+	}
+
+	// Page-aligned slice boundaries, the last slice takes the remainder
+	size_t step = arl_align_up(size / count, ARL_PREFAULT_STRIDE);
+	ArlPrefaultThread workers[ARL_PREFAULT_THREADS];
+	int started[ARL_PREFAULT_THREADS];
+	size_t n = 0;
+	int used = 0;
+
+	for (size_t offset = 0; offset < size; n++) {
+		size_t length = (n == count - 1 || size - offset < step) ? size - offset : step;
+		slices[n] = (ArlPrefaultSlice){ (uint8_t*)ptr + offset, length, mode, node };
+		started[n] = arl_prefault_start(&workers[n], &slices[n]);
+		used += started[n];
+		offset += length;
+	}
+
+	// Slices whose thread could not be created are done here, unpinned
+	for (size_t i = 0; i < n; i++) {
+		if (started[i]) {
+			arl_prefault_join(workers[i]);
+		} else {
+			slices[i].node = ARL_NUMA_ANY;
+			arl_prefault_run(&slices[i]);
+		}
+	}
+
+	return used > 0 ? used : 1;
+}
+
+
+void arl_new_prefault (Armel *armel, size_t size, size_t alignment, uint8_t flags, int threads, int node) {
+	// The mapping is fresh, hence zeroed: ARL_ZEROS only needs the pages committed
+	arl_new_custom(armel, size, alignment, (uint8_t)(flags & ~ARL_ZEROS));
+	armel->flags = flags;
+
+	if (armel->base != NULL) {
+		arl_prefault(armel->base, (size_t)((uint8_t*)armel->end - (uint8_t*)armel->base), ARL_PREFAULT_TOUCH, threads, node);
+	}
+}
@@ -0,0 +1,143 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <Armel/armel.h>
+#include <Armel/armel_profile.h>
+
+/**
+ * @brief Rounding of profile-sized arenas (one page on common platforms).
+ */
+#define ARL_PROFILE_ROUND (4 * ARL_KB)
+
+static void arl_profile_lock (atomic_flag *lock) {
+	while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {}
+}
+
+static void arl_profile_unlock (atomic_flag *lock) {
+	atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+
+ArlProfile* arl_profile_get (ArlProfileSet *set, const char *name, size_t initial) {
+	ArlProfile *profile = NULL;
+
+	arl_profile_lock(&set->lock);
+
+	for (size_t i = 0; i < set->count; i++) {
+		if (strncmp(set->profiles[i].name, name, ARL_PROFILE_NAME - 1) == 0) {
+			profile = &set->profiles[i];
+			break;
+		}
+	}
+
+	if (profile == NULL && set->count < ARL_PROFILE_MAX) {
+		profile = &set->profiles[set->count++];
+		memset(profile, 0, sizeof(*profile));
+		strncpy(profile->name, name, ARL_PROFILE_NAME - 1);
+		profile->initial = initial;
+		profile->percentile = ARL_PROFILE_PERCENTILE;
+		atomic_flag_clear(&profile->lock);
+	}
+
+	arl_profile_unlock(&set->lock);
+	return profile;
+}
+
+
+size_t arl_profile_size (ArlProfile *profile) {
+	arl_profile_lock(&profile->lock);
+	size_t size = profile->samples ? (size_t)profile->estimate : profile->initial;
+	arl_profile_unlock(&profile->lock);
+
+	if (size < ARL_PROFILE_ROUND) {
+		size = ARL_PROFILE_ROUND;
+	}
+	return arl_align_up(size, ARL_PROFILE_ROUND);
+}
+
+
+void arl_profile_new (ArlProfile *profile, Armel *armel) {
+	arl_new(armel, arl_profile_size(profile));
+	arl_set_overflow_handler(armel, arl_overflow_grow, NULL);
+	arl_set_peak_observer(armel, arl_profile_observe, profile);
+}
+
+
+void arl_profile_observe (Armel *armel, size_t peak, void *ctx) {
+	ArlProfile *profile = (ArlProfile*)ctx;
+	double x = (double)peak;
+
+	(void)armel;
+	arl_profile_lock(&profile->lock);
+
+	if (profile->samples++ == 0) {
+		profile->estimate = x;
+	} else {
+		// Stochastic quantile tracking: settles where a `percentile` share of peaks is below.
+		// The step is relative to the estimate, so old history decays geometrically.
+		double step = ARL_PROFILE_RATE * (profile->estimate > x ? profile->estimate : x);
+
+		if (x > profile->estimate) {
+			profile->estimate += step * profile->percentile;
+		} else {
+			profile->estimate -= step * (1.0 - profile->percentile);
+		}
+	}
+
+	arl_profile_unlock(&profile->lock);
+}
+
+
+int arl_profile_save (ArlProfileSet *set, const char *path) {
+	FILE *file = fopen(path, "w");
+	if (file == NULL) {
+		return 0;
+	}
+
+	arl_profile_lock(&set->lock);
+	for (size_t i = 0; i < set->count; i++) {
+		ArlProfile *profile = &set->profiles[i];
+
+		arl_profile_lock(&profile->lock);
+		fprintf(file, "%s %.0f %llu\n", profile->name, profile->estimate,
+				(unsigned long long)profile->samples);
+		arl_profile_unlock(&profile->lock);
+	}
+	arl_profile_unlock(&set->lock);
+
+	return fclose(file) == 0;
+}
+
+
+int arl_profile_load (ArlProfileSet *set, const char *path) {
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return 0;
+	}
+
+	char name[ARL_PROFILE_NAME];
+	double estimate;
+	unsigned long long samples;
+
+	// Field width must match ARL_PROFILE_NAME - 1
+	char format[32];
+	snprintf(format, sizeof(format), "%%%ds %%lf %%llu", ARL_PROFILE_NAME - 1);
+
+	while (fscanf(file, format, name, &estimate, &samples) == 3) {
+		ArlProfile *profile = arl_profile_get(set, name, (size_t)estimate);
+		if (profile == NULL) {
+			break;
+		}
+
+		arl_profile_lock(&profile->lock);
+		profile->estimate = estimate;
+		profile->samples = samples;
+		arl_profile_unlock(&profile->lock);
+	}
+
+	fclose(file);
+	return 1;
+}
@@ -0,0 +1,31 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include <Armel/armel_sys.h>
+#include <Armel/armel.h>
+#include <Armel/armel_ring.h>
+
+void arl_ring_new (ArlRing *ring, size_t capacity) {
+	size_t size = ARL_RING_HEADER * 2;
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	ring->buffer = (uint8_t*)arl_sys_alloc(size);
+	ring->capacity = size;
+	ring->mask = size - 1;
+	ring->pending = 0;
+	ring->tail_seen = 0;
+	ring->head_seen = 0;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+}
+
+
+void arl_ring_free (ArlRing *ring) {
+	arl_sys_free(ring->buffer, ring->capacity);
+	ring->buffer = NULL;
+	ring->capacity = 0;
+	ring->mask = 0;
+}
@@ -1,3 +1,11 @@
+#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE // MAP_ANONYMOUS, memfd_create
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+
 #include <Armel/armel_sys.h>
 #include <Armel/armel.h>
 
@@ -8,15 +16,12 @@
 	 * @brief Allocates a block of memory using Windows VirtualAlloc.
 	 *
 	 * This function reserves and commits a memory region with read/write access.
-	 * It aborts the program if the allocation fails.
 	 *
 	 * @param size The size of memory to allocate in bytes.
-	 * @return A pointer to the allocated memory.
+	 * @return A pointer to the allocated memory, or NULL on failure.
 	 */
-	void* arl_sys_alloc (size_t size) {
-		void *ptr = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-		ARL_ASSERT_FATAL(ptr != NULL, "arl_sys_alloc: VirtualAlloc allocation failed");
-		return ptr;
+	static void* arl_sys_map (size_t size) {
+		return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 	}
 
 	/**
@@ -28,31 +33,92 @@
 	 * @param ptr Pointer to the memory block.
 	 * @param size Size of the memory block in bytes (required by Windows API).
 	 */
-	void arl_sys_free (void *ptr, size_t size) {
+	static void arl_sys_unmap (void *ptr, size_t size) {
 		(void)size;
 		BOOL ok = VirtualFree(ptr, 0, MEM_RELEASE);
     	ARL_ASSERT_FATAL(ok != 0, "arl_sys_free: VirtualFree failed");
 	}
 
+	/**
+	 * @brief Returns the allocation granularity, which views must be aligned to.
+	 */
+	size_t arl_sys_page_size (void) {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return (size_t)info.dwAllocationGranularity;
+	}
+
+	/**
+	 * @brief Maps a pagefile-backed section twice, back-to-back.
+	 *
+	 * Windows cannot map a view over reserved memory, so a free range is found with
+	 * VirtualAlloc, released, then both views are mapped into it. Another thread may
+	 * grab the range in between: the operation is retried a few times.
+	 *
+	 * @param size The size of the region in bytes.
+	 * @return A pointer to the first view, or NULL on failure.
+	 */
+	static void* arl_sys_map_mirror (size_t size) {
+		HANDLE section = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+			(DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+		if (section == NULL) {
+			return NULL;
+		}
+
+		for (int attempt = 0; attempt < 16; attempt++) {
+			uint8_t *range = (uint8_t*)VirtualAlloc(NULL, size * 2, MEM_RESERVE, PAGE_NOACCESS);
+			if (range == NULL) {
+				break;
+			}
+			VirtualFree(range, 0, MEM_RELEASE);
+
+			void *first = MapViewOfFileEx(section, FILE_MAP_ALL_ACCESS, 0, 0, size, range);
+			void *second = first ? MapViewOfFileEx(section, FILE_MAP_ALL_ACCESS, 0, 0, size, range + size) : NULL;
+
+			if (second != NULL) {
+				CloseHandle(section); // views keep the section alive
+				return first;
+			}
+			if (first != NULL) {
+				UnmapViewOfFile(first);
+			}
+		}
+
+		CloseHandle(section);
+		return NULL;
+	}
+
+	/**
+	 * @brief Unmaps both views of a mirrored region.
+	 *
+	 * @param ptr Pointer to the first view.
+	 * @param size Size of one view in bytes.
+	 */
+	static void arl_sys_unmap_mirror (void *ptr, size_t size) {
+		BOOL ok = UnmapViewOfFile((uint8_t*)ptr + size) && UnmapViewOfFile(ptr);
+		ARL_ASSERT_FATAL(ok, "arl_sys_free_mirror: UnmapViewOfFile failed");
+	}
+
 
 #else 
+	#include <fcntl.h>
+	#include <stdio.h>
 	#include <sys/mman.h>
+	#include <sys/stat.h>
 
 	/**
 	 * @brief Allocates a block of memory using mmap on POSIX systems.
 	 *
 	 * This function maps anonymous memory with read/write permissions.
-	 * It aborts the program if the allocation fails.
 	 *
 	 * @param size The size of memory to allocate in bytes.
-	 * @return A pointer to the allocated memory.
+	 * @return A pointer to the allocated memory, or NULL on failure.
 	 */
-	void* arl_sys_alloc (size_t size) {
+	static void* arl_sys_map (size_t size) {
 		void* ptr = mmap(NULL, size, 
 			PROT_READ | PROT_WRITE, 
-			MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
-		ARL_ASSERT_FATAL(ptr != MAP_FAILED, "arl_sys_alloc: mmap allocation failed");
-		return ptr;
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		return ptr != MAP_FAILED ? ptr : NULL;
 	}
 
 	/**
@@ -64,8 +130,262 @@
 	 * @param ptr Pointer to the memory block.
 	 * @param size Size of the memory block in bytes.
 	 */
-	void arl_sys_free (void *ptr, size_t size) {
+	static void arl_sys_unmap (void *ptr, size_t size) {
 		int result = munmap(ptr, size);
 		ARL_ASSERT_FATAL(result == 0, "arl_sys_free : Unable to deallocate memory");
 	}
-#endif
\ No newline at end of file
+
+	/**
+	 * @brief Returns the system page size.
+	 */
+	size_t arl_sys_page_size (void) {
+		return (size_t)sysconf(_SC_PAGESIZE);
+	}
+
+	/**
+	 * @brief Creates an anonymous shared memory object of the given size.
+	 *
+	 * Uses memfd_create on Linux, and an immediately unlinked shm_open object elsewhere.
+	 *
+	 * @return The descriptor, or -1 on failure.
+	 */
+	static int arl_sys_shared_fd (size_t size) {
+	#if defined(__linux__)
+		int fd = memfd_create("armel", MFD_CLOEXEC);
+	#else
+		static unsigned counter = 0;
+		char name[32];
+		snprintf(name, sizeof(name), "/armel-%d-%u", (int)getpid(), counter++);
+		int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fd >= 0) {
+			shm_unlink(name);
+		}
+	#endif
+		if (fd >= 0 && ftruncate(fd, (off_t)size) != 0) {
+			close(fd);
+			fd = -1;
+		}
+		return fd;
+	}
+
+	/**
+	 * @brief Maps a shared memory object twice, back-to-back.
+	 *
+	 * Reserves 2 * size bytes of address space, then maps the object over both
+	 * halves with MAP_FIXED.
+	 *
+	 * @param size The size of the region in bytes.
+	 * @return A pointer to the first mapping, or NULL on failure.
+	 */
+	static void* arl_sys_map_mirror (size_t size) {
+		int fd = arl_sys_shared_fd(size);
+		if (fd < 0) {
+			return NULL;
+		}
+
+		uint8_t *range = (uint8_t*)mmap(NULL, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (range == MAP_FAILED) {
+			close(fd);
+			return NULL;
+		}
+
+		void *first  = mmap(range, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+		void *second = mmap(range + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+		close(fd);
+
+		if (first != range || second != range + size) {
+			munmap(range, size * 2);
+			return NULL;
+		}
+		return range;
+	}
+
+	/**
+	 * @brief Unmaps both halves of a mirrored region.
+	 *
+	 * @param ptr Pointer to the first mapping.
+	 * @param size Size of one mapping in bytes.
+	 */
+	static void arl_sys_unmap_mirror (void *ptr, size_t size) {
+		int result = munmap(ptr, size * 2);
+		ARL_ASSERT_FATAL(result == 0, "arl_sys_free_mirror : Unable to deallocate memory");
+	}
+#endif
+
+
+// ---- Budget ---- //
+
+/**
+ * @brief Process-wide accountant of system memory mapped by Armel.
+ *
+ * Counters and limits are atomics: charging a mapping is a fetch-add, never a lock.
+ */
+static struct {
+	_Atomic size_t used;
+	_Atomic size_t soft;
+	_Atomic size_t hard;
+	_Atomic(ArlBudgetFn) on_soft;
+	_Atomic(void*) ctx;
+	_Atomic size_t tags[ARL_BUDGET_TAGS];
+	const char *names[ARL_BUDGET_TAGS];
+	_Atomic int count;
+	atomic_flag lock;
+} arl_budget = { .count = 1, .lock = ATOMIC_FLAG_INIT };
+
+static _Thread_local int arl_budget_thread_tag = 0;
+static _Thread_local int arl_budget_thread_refused = 0;
+
+/**
+ * @brief Charges `size` bytes to the budget and to `tag`.
+ * @return 1 if the charge fits under the hard limit, 0 otherwise (nothing charged).
+ */
+static int arl_budget_charge (size_t size, int tag) {
+	size_t hard = atomic_load_explicit(&arl_budget.hard, memory_order_relaxed);
+	size_t used = atomic_fetch_add_explicit(&arl_budget.used, size, memory_order_relaxed) + size;
+
+	if (hard != 0 && used > hard) {
+		atomic_fetch_sub_explicit(&arl_budget.used, size, memory_order_relaxed);
+		return 0;
+	}
+	atomic_fetch_add_explicit(&arl_budget.tags[tag], size, memory_order_relaxed);
+
+	// Only the allocation crossing the soft limit fires the callback
+	size_t soft = atomic_load_explicit(&arl_budget.soft, memory_order_relaxed);
+	if (soft != 0 && used > soft && used - size <= soft) {
+		ArlBudgetFn fn = atomic_load_explicit(&arl_budget.on_soft, memory_order_acquire);
+		if (fn != NULL) {
+			fn(used, atomic_load_explicit(&arl_budget.ctx, memory_order_relaxed));
+		}
+	}
+	return 1;
+}
+
+static void arl_budget_refund (size_t size, int tag) {
+	atomic_fetch_sub_explicit(&arl_budget.tags[tag], size, memory_order_relaxed);
+	atomic_fetch_sub_explicit(&arl_budget.used, size, memory_order_relaxed);
+}
+
+
+void* arl_sys_try_alloc (size_t size, int tag) {
+	if (!arl_budget_charge(size, tag)) {
+		arl_budget_thread_refused = 1;
+		return NULL;
+	}
+
+	void *ptr = arl_sys_map(size);
+	if (ptr == NULL) {
+		arl_budget_refund(size, tag);
+		arl_budget_thread_refused = 0;
+	}
+	return ptr;
+}
+
+
+void* arl_sys_alloc (size_t size) {
+	void *ptr = arl_sys_try_alloc(size, 0);
+	ARL_ASSERT_FATAL(ptr != NULL, "arl_sys_alloc: allocation failed or memory budget exceeded");
+	return ptr;
+}
+
+
+void arl_sys_free_tag (void *ptr, size_t size, int tag) {
+	arl_sys_unmap(ptr, size);
+	arl_budget_refund(size, tag);
+}
+
+
+void arl_sys_free (void *ptr, size_t size) {
+	arl_sys_free_tag(ptr, size, 0);
+}
+
+
+void* arl_sys_alloc_mirror (size_t size) {
+	if (!arl_budget_charge(size, 0)) {
+		return NULL;
+	}
+
+	void *ptr = arl_sys_map_mirror(size);
+	if (ptr == NULL) {
+		arl_budget_refund(size, 0);
+	}
+	return ptr;
+}
+
+
+void arl_sys_free_mirror (void *ptr, size_t size) {
+	arl_sys_unmap_mirror(ptr, size);
+	arl_budget_refund(size, 0);
+}
+
+
+void arl_budget_set (size_t soft, size_t hard, ArlBudgetFn on_soft, void *ctx) {
+	atomic_store_explicit(&arl_budget.ctx, ctx, memory_order_relaxed);
+	atomic_store_explicit(&arl_budget.on_soft, on_soft, memory_order_release);
+	atomic_store_explicit(&arl_budget.soft, soft, memory_order_relaxed);
+	atomic_store_explicit(&arl_budget.hard, hard, memory_order_relaxed);
+}
+
+
+size_t arl_budget_used (void) {
+	return atomic_load_explicit(&arl_budget.used, memory_order_relaxed);
+}
+
+
+int arl_budget_refused (void) {
+	return arl_budget_thread_refused;
+}
+
+
+int arl_budget_tag (const char *name) {
+	int tag = -1;
+
+	while (atomic_flag_test_and_set_explicit(&arl_budget.lock, memory_order_acquire)) {}
+
+	int count = atomic_load_explicit(&arl_budget.count, memory_order_relaxed);
+	for (int i = 1; i < count; i++) {
+		if (strcmp(arl_budget.names[i], name) == 0) {
+			tag = i;
+		}
+	}
+	if (tag < 0 && count < ARL_BUDGET_TAGS) {
+		tag = count;
+		arl_budget.names[tag] = name;
+		atomic_store_explicit(&arl_budget.count, count + 1, memory_order_release);
+	}
+
+	atomic_flag_clear_explicit(&arl_budget.lock, memory_order_release);
+	return tag;
+}
+
+
+const char* arl_budget_tag_name (int tag) {
+	if (tag <= 0 || tag >= atomic_load_explicit(&arl_budget.count, memory_order_acquire)) {
+		return "untagged";
+	}
+	return arl_budget.names[tag];
+}
+
+
+/**
+ * @brief Returns `tag` if it was registered, 0 (untagged) otherwise.
+ */
+static int arl_budget_valid (int tag) {
+	return (tag > 0 && tag < atomic_load_explicit(&arl_budget.count, memory_order_acquire)) ? tag : 0;
+}
+
+
+size_t arl_budget_tag_used (int tag) {
+	return atomic_load_explicit(&arl_budget.tags[arl_budget_valid(tag)], memory_order_relaxed);
+}
+
+
+int arl_budget_use (int tag) {
+	int previous = arl_budget_thread_tag;
+	arl_budget_thread_tag = arl_budget_valid(tag);
+	return previous;
+}
+
+
+int arl_budget_current (void) {
+	return arl_budget_thread_tag;
+}
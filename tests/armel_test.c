@@ -1,4 +1,25 @@
 #include <Armel/armel_test.h>
+#include <Armel/armel_epoch.h>
+#include <Armel/armel_frame.h>
+#include <Armel/armel_ring.h>
+#include <Armel/armel_mirror.h>
+#include <Armel/armel_log.h>
+#include <Armel/armel_mpsc.h>
+#include <Armel/armel_pool.h>
+#include <Armel/armel_profile.h>
+#include <Armel/armel_ref.h>
+#include <Armel/armel_handle.h>
+#include <Armel/armel_bitmap.h>
+#include <Armel/armel_buddy.h>
+#include <Armel/armel_file.h>
+#include <Armel/armel_output.h>
+#include <Armel/armel_clone.h>
+#include <Armel/armel_gc.h>
+#include <Armel/armel_prefault.h>
+
+#ifndef _WIN32
+    #include <sys/stat.h>
+#endif
 
 ARMEL_TEST(test_arl_local_alloc) {
 	Armel a;
@@ -443,6 +464,1377 @@ ARMEL_TEST(test_arl_alloc_softfail_null) {
 }
 
 
+ARMEL_TEST(test_arl_overflow_grow) {
+    Armel arena;
+    arl_new(&arena, 64);
+    arl_set_overflow_handler(&arena, arl_overflow_grow, NULL);
+
+    void* first = arl_alloc(&arena, 16);
+    int* values[256];
+    for (int i = 0; i < 256; i++) {
+        values[i] = arl_make(&arena, int);
+        assert(((uintptr_t)values[i] % arena.alignment) == 0);
+        *values[i] = i;
+    }
+    for (int i = 0; i < 256; i++) {
+        assert(*values[i] == i);
+    }
+    assert(arena.records != NULL);
+
+    uintptr_t mark = arl_offset(&arena);
+    void* big = arl_alloc(&arena, 8 * ARL_KB);
+    assert(big != NULL);
+    arl_rewind_to(&arena, mark);
+    assert(arl_offset(&arena) == mark);
+
+    arl_reset(&arena);
+    assert(arena.records == NULL);
+    assert(arena.spare != NULL);
+    assert(arl_alloc(&arena, 16) == first);
+
+    arl_free(&arena);
+    assert(arena.spare == NULL);
+
+    // A size whose block would wrap fails instead of returning an unbacked pointer
+    arl_new_custom(&arena, 64, ARL_ALIGN, ARL_SOFTFAIL);
+    arl_set_overflow_handler(&arena, arl_overflow_grow, NULL);
+    assert(arl_alloc(&arena, SIZE_MAX - 8) == NULL);
+    assert(arl_overflow_grow(&arena, SIZE_MAX - 8, NULL) == NULL);
+    assert(arl_offset(&arena) == 0 && arena.records == NULL);
+    arl_set_overflow_handler(&arena, arl_overflow_malloc, NULL);
+    assert(arl_alloc(&arena, SIZE_MAX - 8) == NULL);
+    assert(arl_overflow_malloc(&arena, SIZE_MAX, NULL) == NULL);
+    assert(arena.records == NULL);
+    arl_free(&arena);
+}
+
+ARMEL_TEST(test_arl_overflow_malloc) {
+    Armel arena;
+    arl_new_custom(&arena, 32, ARL_ALIGN, ARL_ZEROS);
+    arl_set_overflow_handler(&arena, arl_overflow_malloc, NULL);
+
+    uintptr_t mark = arl_offset(&arena);
+    unsigned char* big = arl_alloc(&arena, 4096);
+    assert(big != NULL);
+    assert(((uintptr_t)big % arena.alignment) == 0);
+    for (int i = 0; i < 4096; i++) {
+        assert(big[i] == 0);
+    }
+    assert(arl_used(&arena) >= 4096);
+
+    int* small = arl_make(&arena, int);
+    assert(small != NULL);
+
+    arl_rewind_to(&arena, mark);
+    assert(arena.records == NULL);
+    assert(arl_offset(&arena) == mark);
+
+    arl_free(&arena);
+}
+
+ARMEL_TEST(test_arl_overflow_parent) {
+    Armel parent, child;
+    arl_new(&parent, ARL_KB);
+    arl_new(&child, 32);
+    arl_set_overflow_handler(&child, arl_overflow_parent, &parent);
+
+    void* spilled = arl_alloc(&child, 256);
+    assert((uintptr_t)spilled >= (uintptr_t)parent.base);
+    assert((uintptr_t)spilled + 256 <= (uintptr_t)parent.end);
+    assert(arl_used(&parent) >= 256);
+
+    arl_free(&child);
+    arl_free(&parent);
+}
+
+static void* count_overflow (Armel *armel, size_t size, void *ctx) {
+    (void)armel;
+    (void)size;
+    (*(int*)ctx)++;
+    return NULL;
+}
+
+ARMEL_TEST(test_arl_overflow_custom) {
+    Armel arena;
+    int calls = 0;
+    arl_new(&arena, 32);
+    arl_set_overflow_handler(&arena, count_overflow, &calls);
+
+    assert(arl_alloc(&arena, 16) != NULL);
+    assert(calls == 0);
+    assert(arl_alloc(&arena, 64) == NULL);
+    assert(calls == 1);
+
+    arl_set_overflow_handler(&arena, arl_overflow_null, NULL);
+    assert(arl_alloc(&arena, 64) == NULL);
+
+    arl_free(&arena);
+}
+
+static void should_abort_on_abort_policy() {
+    Armel a;
+    arl_new_custom(&a, 8, ARL_ALIGN, ARL_SOFTFAIL);
+    arl_set_overflow_handler(&a, arl_overflow_abort, NULL);
+    (void)arl_alloc(&a, 64);  // policy overrides ARL_SOFTFAIL -> should abort
+}
+
+ARMEL_TEST(test_arl_overflow_abort_policy) {
+    expect_abort(should_abort_on_abort_policy, "arl_overflow_abort: overflow with policy");
+}
+
+
+ARMEL_TEST(test_arl_large_bypass) {
+    Armel arena;
+    arl_new(&arena, 4 * ARL_KB);
+    arl_set_large_threshold(&arena, ARL_KB);
+
+    char* small = arl_array(&arena, char, 512);
+    uintptr_t mark = arl_offset(&arena);
+
+    char* big = arl_array(&arena, char, 64 * ARL_KB);
+    assert(big != NULL);
+    assert((uintptr_t)big % arena.alignment == 0);
+    assert((uintptr_t)big < (uintptr_t)arena.base || (uintptr_t)big >= (uintptr_t)arena.end);
+    memset(big, 0xAB, 64 * ARL_KB);
+    assert(arl_used(&arena) >= mark + 64 * ARL_KB);
+
+    char* after = arl_array(&arena, char, 512);
+    assert((uintptr_t)after > (uintptr_t)small);
+    assert((uintptr_t)after < (uintptr_t)arena.end);
+
+    arl_rewind_to(&arena, mark);
+    assert(arena.records == NULL);
+    assert(arl_offset(&arena) == mark);
+
+    char* again = arl_array(&arena, char, 64 * ARL_KB);
+    assert(again == big);   // recycled from the arena's cache
+
+    arl_reset(&arena);
+    assert(arena.records == NULL);
+    assert((void*)arl_array(&arena, char, 512) == (void*)small);
+
+    arl_free(&arena);
+
+    // A size whose dedicated block would wrap fails softly
+    arl_new_custom(&arena, 4 * ARL_KB, ARL_ALIGN, ARL_SOFTFAIL);
+    arl_set_large_threshold(&arena, ARL_KB);
+    assert(arl_alloc(&arena, SIZE_MAX - 8) == NULL);
+    assert(arl_alloc(&arena, SIZE_MAX - ARL_KB) == NULL);
+    assert(arena.records == NULL && arl_offset(&arena) == 0);
+    arl_free(&arena);
+}
+
+
+ARMEL_TEST(test_arl_cache_best_fit) {
+    Armel arena;
+    arl_new(&arena, 4 * ARL_KB);
+    arl_set_large_threshold(&arena, ARL_KB);
+
+    char* p8 = arl_array(&arena, char, 8 * ARL_KB);
+    char* p64 = arl_array(&arena, char, 64 * ARL_KB);
+    char* p16 = arl_array(&arena, char, 16 * ARL_KB);
+    arl_reset(&arena);
+
+    // The smallest block that fits, not the first one
+    assert(arl_array(&arena, char, 12 * ARL_KB) == p16);
+    assert(arl_array(&arena, char, 2 * ARL_KB) == p8);
+
+    // A small request does not consume a much larger block
+    assert(arl_array(&arena, char, 2 * ARL_KB) != p64);
+    arl_reset(&arena);
+    assert(arl_array(&arena, char, 60 * ARL_KB) == p64);
+    arl_reset(&arena);
+
+    // Blocks past ARL_CACHE_BYTES go back to the system
+    (void)arl_alloc(&arena, ARL_CACHE_BYTES);
+    arl_reset(&arena);
+    size_t cached = 0;
+    for (ArlRecord* block = arena.spare; block != NULL; block = block->prev) cached += block->size;
+    assert(cached <= ARL_CACHE_BYTES);
+
+    arl_free(&arena);
+}
+
+static void count_retired (Armel *armel, void *ctx) {
+    (*(int*)ctx)++;
+    arl_reset(armel);
+}
+
+ARMEL_TEST(test_arl_epoch_reclaim) {
+    static ArlEpoch domain;
+    arl_epoch_init(&domain);
+
+    ArlEpochReader* early = arl_epoch_register(&domain);
+    ArlEpochReader* late = arl_epoch_register(&domain);
+    assert(early != NULL && late != NULL && early != late);
+
+    Armel snapshot;
+    arl_new(&snapshot, ARL_KB);
+    (void)arl_array(&snapshot, int, 16);
+
+    arl_epoch_enter(&domain, early);
+    arl_epoch_retire(&domain, &snapshot, NULL, NULL);
+
+    arl_epoch_enter(&domain, late);  // started after retirement: does not block it
+    assert(arl_epoch_reclaim(&domain) == 0);
+    assert(arl_used(&snapshot) > 0);
+
+    arl_epoch_exit(early);
+    assert(arl_epoch_reclaim(&domain) == 1);
+    assert(arl_used(&snapshot) == 0);
+
+    int recycled = 0;
+    arl_epoch_retire(&domain, &snapshot, count_retired, &recycled);
+    assert(arl_epoch_reclaim(&domain) == 0);  // late reader is still inside
+    arl_epoch_exit(late);
+    arl_epoch_drain(&domain);
+    assert(recycled == 1);
+
+    arl_epoch_unregister(early);
+    arl_epoch_unregister(late);
+    arl_free(&snapshot);
+}
+
+
+ARMEL_TEST(test_arl_frame_rotation) {
+    ArlFrameRing frames;
+    arl_frame_new(&frames, 2, ARL_KB, ARL_NOFLAG);
+
+    Armel* first = arl_frame_current(&frames);
+    int* old = arl_make(first, int);
+    *old = 42;
+
+    Armel* second = arl_frame_advance(&frames);
+    assert(second != first);
+    assert(*old == 42);                      // previous frame still readable
+    int* kept = arl_frame_promote(&frames, old, sizeof(int));
+    assert(*kept == 42);
+    assert(arl_frame_peak(&frames) >= sizeof(int));
+
+    Armel* third = arl_frame_advance(&frames);
+    assert(third == first);
+    assert(arl_used(third) == 0);            // oldest frame was reset
+    assert(*kept == 42);                     // promoted copy survives one more frame
+
+    arl_frame_free(&frames);
+}
+
+ARMEL_TEST(test_arl_frame_adaptive) {
+    ArlFrameRing frames;
+    arl_frame_new(&frames, 2, ARL_KB, ARL_FRAME_ADAPTIVE);
+
+    for (int i = 0; i < 4; i++) {
+        (void)arl_alloc(arl_frame_current(&frames), 8 * ARL_KB);  // outgrows the arena
+        arl_frame_advance(&frames);
+    }
+
+    Armel* frame = arl_frame_current(&frames);
+    assert(frame->records == NULL);
+    assert((size_t)((uintptr_t)frame->end - (uintptr_t)frame->base) >= 8 * ARL_KB);
+    assert(frames.max_peak >= 8 * ARL_KB);
+
+    arl_frame_free(&frames);
+}
+
+
+ARMEL_TEST(test_arl_ring_fifo) {
+    ArlRing ring;
+    arl_ring_new(&ring, 256);
+    assert(ring.capacity == 256);
+
+    size_t size;
+    assert(arl_ring_peek(&ring, &size) == NULL);
+
+    // Records are only visible once committed
+    char* first = arl_ring_alloc(&ring, 10);
+    memcpy(first, "armel-ring", 10);
+    assert(arl_ring_peek(&ring, &size) == NULL);
+    arl_ring_commit(&ring);
+    char* read = arl_ring_peek(&ring, &size);
+    assert(read == first && size == 10);
+    assert(memcmp(read, "armel-ring", 10) == 0);
+    arl_ring_release(&ring);
+
+    // Variable sizes force wrap-arounds: order and contents must be preserved
+    unsigned char next = 0, expect = 0;
+    for (int round = 0; round < 200; round++) {
+        size_t len = (size_t)(round % 37) + 1;
+        unsigned char* rec = arl_ring_alloc(&ring, len);
+        while (rec == NULL) {
+            unsigned char* old = arl_ring_peek(&ring, &size);
+            assert(old != NULL);
+            assert(((uintptr_t)old % ARL_ALIGN) == 0);
+            assert(old[0] == expect && old[size - 1] == expect);
+            expect++;
+            arl_ring_release(&ring);
+            rec = arl_ring_alloc(&ring, len);
+        }
+        memset(rec, next++, len);
+        arl_ring_commit(&ring);
+    }
+    unsigned char* old;
+    while ((old = arl_ring_peek(&ring, &size)) != NULL) {
+        assert(old[0] == expect && old[size - 1] == expect);
+        expect++;
+        arl_ring_release(&ring);
+    }
+    assert(expect == next);
+
+    assert(arl_ring_alloc(&ring, 512) == NULL);   // larger than the ring
+    arl_ring_free(&ring);
+}
+
+
+ARMEL_TEST(test_arl_mirror_wrap) {
+    ArlMirror stream;
+    assert(arl_mirror_new(&stream, 1) == 1);
+    size_t cap = stream.capacity;
+    assert(cap >= arl_sys_page_size());
+
+    // Both halves of the mapping are the same memory
+    stream.buffer[0] = 'a';
+    assert(stream.buffer[cap] == 'a');
+
+    size_t avail;
+    assert(arl_mirror_peek(&stream, &avail) == NULL && avail == 0);
+
+    // Move the cursors close to the end, then write a span across the wrap point
+    char* fill = arl_mirror_reserve(&stream, cap - 10);
+    memset(fill, '.', cap - 10);
+    arl_mirror_commit(&stream, cap - 10);
+    (void)arl_mirror_peek(&stream, &avail);
+    arl_mirror_consume(&stream, avail);
+
+    char* dst = arl_mirror_reserve(&stream, 26);
+    assert(dst != NULL);
+    memcpy(dst, "abcdefghijklmnopqrstuvwxyz", 26);
+    arl_mirror_commit(&stream, 26);
+
+    char* src = arl_mirror_peek(&stream, &avail);
+    assert(avail == 26);
+    assert(memcmp(src, "abcdefghijklmnopqrstuvwxyz", 26) == 0);
+    assert(memcmp(stream.buffer, "klmnopqrstuvwxyz", 16) == 0);  // wrapped part
+
+    assert(arl_mirror_reserve(&stream, cap - 25) == NULL);       // full
+    arl_mirror_consume(&stream, 26);
+    assert(arl_mirror_reserve(&stream, cap) != NULL);
+
+    arl_mirror_free(&stream);
+}
+
+
+ARMEL_TEST(test_arl_log_publication) {
+    ArlLog log;
+    arl_log_new(&log, 256);
+
+    int* a = arl_log_reserve(&log, sizeof(int));
+    int* b = arl_log_reserve(&log, sizeof(int));
+    assert(a != NULL && b != NULL && a != b);
+    *a = 1;
+    *b = 2;
+
+    // Records are consumed in reservation order, not commit order
+    arl_log_commit(b);
+    size_t size;
+    assert(arl_log_next(&log, &size) == NULL);
+    assert(arl_log_reset(&log) == 0);
+    arl_log_commit(a);
+
+    int* first = arl_log_next(&log, &size);
+    assert(first == a && *first == 1 && size == sizeof(int));
+    arl_log_consume(&log);
+    int* second = arl_log_next(&log, &size);
+    assert(second == b && *second == 2);
+    arl_log_consume(&log);
+    assert(arl_log_next(&log, &size) == NULL);
+
+    assert(arl_log_reset(&log) == 1);
+    assert(arl_log_reserve(&log, sizeof(int)) == (void*)a);
+    assert(arl_log_reset(&log) == 0);   // pending reservation
+
+    // Fill the log: the consumer stops at the end marker, then the log resets
+    arl_log_commit(a);
+    void* rec;
+    while ((rec = arl_log_reserve(&log, 40)) != NULL) {
+        arl_log_commit(rec);
+    }
+    int count = 0;
+    while (arl_log_next(&log, NULL) != NULL) {
+        arl_log_consume(&log);
+        count++;
+    }
+    assert(count >= 2);
+    assert(arl_log_reset(&log) == 1);
+    assert(arl_log_next(&log, NULL) == NULL);
+
+    // Next rounds: headers land on old payload bytes equal to the header states
+    for (uint32_t fill = ARL_LOG_COMMITTED; fill <= ARL_LOG_END; fill++) {
+        uint32_t* big = arl_log_reserve(&log, 64);
+        for (int i = 0; i < 16; i++) big[i] = fill;
+        arl_log_commit(big);
+        assert(arl_log_next(&log, NULL) == big);
+        arl_log_consume(&log);
+        assert(arl_log_next(&log, NULL) == NULL);
+        assert(arl_log_reset(&log) == 1);
+
+        void* small = arl_log_reserve(&log, 8);
+        arl_log_commit(small);
+        assert(arl_log_next(&log, &size) == small && size == 8);
+        arl_log_consume(&log);
+        assert(arl_log_next(&log, &size) == NULL);  // no phantom record past the cursor
+        assert(log.read == atomic_load(&log.cursor));
+
+        // An uncommitted reservation on old payload bytes stays invisible
+        void* pending = arl_log_reserve(&log, 8);
+        assert(arl_log_next(&log, NULL) == NULL);
+        arl_log_commit(pending);
+        assert(arl_log_next(&log, NULL) == pending);
+        arl_log_consume(&log);
+        assert(arl_log_reset(&log) == 1);
+    }
+
+    arl_log_free(&log);
+}
+
+
+ARMEL_TEST(test_arl_mpsc_recycle) {
+    static ArlMpsc queue;
+    ArlMpscProducer a;
+    ArlMpscProducer* b = malloc(sizeof(ArlMpscProducer));    // freed before the last flush
+    arl_mpsc_new(&queue);
+    arl_mpsc_producer_new(&queue, &a, ARL_KB);
+    arl_mpsc_producer_new(&queue, b, ARL_KB);
+
+    size_t size;
+    assert(arl_mpsc_pop(&queue, &size) == NULL);
+
+    int* first = arl_mpsc_alloc(&a, sizeof(int));
+    *first = 1;
+    arl_mpsc_send(&queue, first);
+    int* second = arl_mpsc_alloc(b, sizeof(int));
+    *second = 2;
+    arl_mpsc_send(&queue, second);
+    int* third = arl_mpsc_alloc(&a, sizeof(int));
+    *third = 3;
+    arl_mpsc_send(&queue, third);
+
+    for (int expect = 1; expect <= 3; expect++) {
+        int* msg = arl_mpsc_pop(&queue, &size);
+        assert(msg != NULL && *msg == expect && size == sizeof(int));
+        arl_mpsc_done(&queue, msg);
+    }
+    assert(arl_mpsc_pop(&queue, &size) == NULL);
+
+    // Acks are batched: the arena is only recycled once they are published
+    int* blocked = arl_mpsc_alloc(&a, sizeof(int));
+    assert(blocked != first);
+    arl_mpsc_send(&queue, blocked);
+    arl_mpsc_done(&queue, arl_mpsc_pop(&queue, NULL));
+    arl_mpsc_flush(&queue);
+    assert(arl_mpsc_alloc(&a, sizeof(int)) == first);
+
+    // A freed producer is unregistered: later flushes skip it
+    int* last = arl_mpsc_alloc(b, sizeof(int));
+    arl_mpsc_send(&queue, last);
+    arl_mpsc_done(&queue, arl_mpsc_pop(&queue, NULL));
+    arl_mpsc_flush(&queue);
+    arl_mpsc_producer_free(&queue, b);
+    assert(atomic_load(&queue.producers[1]) == NULL);
+    free(b);
+    arl_mpsc_flush(&queue);
+    assert(atomic_load(&queue.flushing) % 2 == 0);
+
+    // Freed slots are reused: many producers over the queue's lifetime are fine
+    for (int i = 0; i < 2 * ARL_MPSC_MAX_PRODUCERS; i++) {
+        ArlMpscProducer churn;
+        arl_mpsc_producer_new(&queue, &churn, ARL_KB);
+        assert(churn.slot == 1 && atomic_load(&queue.producers[1]) == &churn);
+        arl_mpsc_producer_free(&queue, &churn);
+    }
+    assert(atomic_load(&queue.count) == 2);
+
+    arl_mpsc_producer_free(&queue, &a);
+    assert(atomic_load(&queue.producers[0]) == NULL);
+}
+
+
+ARMEL_TEST(test_arl_detach_attach) {
+    Armel origin, consumer;
+    arl_new(&origin, ARL_KB);
+    arl_new(&consumer, ARL_KB);
+    arl_set_overflow_handler(&origin, arl_overflow_grow, NULL);
+
+    int* kept = arl_array(&origin, int, 16);
+    uintptr_t mark = arl_detach_mark(&origin);
+    int* values = arl_array(&origin, int, 4096);     // spans a chained block
+    for (int i = 0; i < 4096; i++) values[i] = i;
+
+    ArlDetached handle = arl_detach(&origin, mark);
+    assert(handle.records != NULL && handle.size >= 4096 * sizeof(int));
+    assert(arl_offset(&origin) == mark);
+
+    // The origin keeps allocating without touching the detached data
+    int* other = arl_array(&origin, int, 4096);
+    memset(other, 0xFF, 4096 * sizeof(int));
+    assert(kept != NULL && values[0] == 0 && values[4095] == 4095);
+
+    arl_attach(&consumer, &handle);
+    assert(handle.records == NULL);
+    assert(origin.inbox == NULL);
+
+    // Resetting the consumer hands the blocks back to the origin's cache
+    arl_reset(&consumer);
+    assert(origin.inbox != NULL);
+    arl_reset(&origin);
+    (void)arl_array(&origin, int, 4096);
+    assert(origin.inbox == NULL);
+
+    arl_free(&consumer);
+    arl_free(&origin);
+}
+
+static void should_abort_on_unaligned_detach() {
+    Armel a;
+    arl_new(&a, ARL_KB);
+    uintptr_t mark = arl_offset(&a);
+    (void)arl_alloc(&a, 64);   // lands in the root block, which cannot move
+    (void)arl_detach(&a, mark);
+}
+
+ARMEL_TEST(test_arl_detach_unaligned_abort) {
+    expect_abort(should_abort_on_unaligned_detach, "arl_detach: mark inside a block");
+}
+
+
+ARMEL_TEST(test_arl_pool_remote_free) {
+    Armel arena;
+    ArlPool pool;
+    arl_new(&arena, ARL_KB);
+    arl_pool_new(&pool, &arena, 24);
+    assert(pool.size >= 24 && pool.size % arena.alignment == 0);
+
+    void* a = arl_pool_alloc(&pool);
+    void* b = arl_pool_alloc(&pool);
+    assert(a != NULL && b != NULL && a != b);
+
+    // Owner frees are reused first, in LIFO order
+    arl_pool_free(&pool, a);
+    assert(arl_pool_alloc(&pool) == a);
+
+    // Remote frees are drained in one batch on the next miss
+    uintptr_t used = arl_offset(&arena);
+    arl_pool_free_remote(&pool, a);
+    arl_pool_free_remote(&pool, b);
+    void* first = arl_pool_alloc(&pool);
+    void* second = arl_pool_alloc(&pool);
+    assert((first == b && second == a));
+    assert(arl_offset(&arena) == used);
+    assert(atomic_load(&pool.remote) == NULL);
+
+    void* fresh = arl_pool_alloc(&pool);
+    assert(fresh != a && fresh != b);
+    assert(arl_offset(&arena) == used + pool.size);
+
+    arl_reset(&arena);
+    arl_pool_reset(&pool);
+    assert(arl_pool_alloc(&pool) == a);
+
+    arl_free(&arena);
+}
+
+
+static int deferred_order[8];
+static int deferred_count;
+
+static void record_deferred (void *ctx) {
+    deferred_order[deferred_count++] = *(int*)ctx;
+}
+
+ARMEL_TEST(test_arl_defer_lifo) {
+    static int ids[] = { 1, 2, 3, 4 };
+    Armel arena;
+    arl_new(&arena, 256);
+    arl_set_overflow_handler(&arena, arl_overflow_grow, NULL);
+    deferred_count = 0;
+
+    assert(arl_defer(&arena, record_deferred, &ids[0]) == 1);
+    uintptr_t mark = arl_offset(&arena);
+    assert(arl_defer(&arena, record_deferred, &ids[1]) == 1);
+    (void)arl_alloc(&arena, 1024);                    // chains a block
+    assert(arl_defer(&arena, record_deferred, &ids[2]) == 1);
+
+    // Rewinding to an offset taken after a finalizer leaves it registered
+    uintptr_t after = arl_offset(&arena);
+    arl_rewind_to(&arena, after);
+    assert(deferred_count == 0);
+
+    arl_rewind_to(&arena, mark);
+    assert(deferred_count == 2);
+    assert(deferred_order[0] == 3 && deferred_order[1] == 2);
+
+    assert(arl_defer(&arena, record_deferred, &ids[3]) == 1);
+    arl_reset(&arena);
+    assert(deferred_count == 4);
+    assert(deferred_order[2] == 4 && deferred_order[3] == 1);
+
+    arl_free(&arena);
+    assert(deferred_count == 4);
+
+    // No room for the record with ARL_SOFTFAIL
+    Armel tiny;
+    arl_new_custom(&tiny, 8, ARL_ALIGN, ARL_SOFTFAIL);
+    assert(arl_defer(&tiny, record_deferred, &ids[0]) == 0);
+    arl_free(&tiny);
+}
+
+
+static Armel* detached_origin;
+static int detached_inbox_seen;
+
+static void record_detached (void *ctx) {
+    record_deferred(ctx);
+    detached_inbox_seen |= detached_origin->inbox != NULL;
+}
+
+ARMEL_TEST(test_arl_detach_defer_order) {
+    static int ids[] = { 1, 2 };
+    Armel origin;
+    arl_new(&origin, 256);
+    arl_set_overflow_handler(&origin, arl_overflow_grow, NULL);
+    detached_origin = &origin;
+    detached_inbox_seen = 0;
+    deferred_count = 0;
+
+    // Both records live in the detached blocks
+    uintptr_t mark = arl_detach_mark(&origin);
+    assert(arl_defer(&origin, record_detached, &ids[0]) == 1);
+    (void)arl_alloc(&origin, 1024);                   // chains a block
+    assert(arl_defer(&origin, record_detached, &ids[1]) == 1);
+
+    ArlDetached handle = arl_detach(&origin, mark);
+    arl_release(&handle);
+
+    // LIFO like arl_reset, and no block handed back before its finalizers ran
+    assert(deferred_count == 2);
+    assert(deferred_order[0] == 2 && deferred_order[1] == 1);
+    assert(detached_inbox_seen == 0);
+    assert(origin.inbox != NULL);
+
+    arl_free(&origin);
+}
+
+ARMEL_TEST(test_arl_profile_sizing) {
+    static ArlProfileSet set;
+    ArlProfile* profile = arl_profile_get(&set, "request", 8 * ARL_KB);
+    assert(profile != NULL && arl_profile_get(&set, "request", 0) == profile);
+    assert(arl_profile_size(profile) == 8 * ARL_KB);
+
+    // The peak includes chained blocks, and survives a rewind before the reset
+    Armel arena;
+    arl_profile_new(profile, &arena);
+    (void)arl_alloc(&arena, 40 * ARL_KB);
+    arl_rewind_to(&arena, 0);
+    (void)arl_alloc(&arena, 64);
+    arl_reset(&arena);
+    assert(profile->samples == 1);
+    assert(profile->estimate >= 40 * ARL_KB);
+
+    // Smaller peaks pull the estimate down slowly
+    (void)arl_alloc(&arena, 4 * ARL_KB);
+    arl_free(&arena);
+    assert(profile->samples == 2);
+    assert(profile->estimate < 40 * ARL_KB + 64 && profile->estimate > 32 * ARL_KB);
+
+    Armel next;
+    arl_profile_new(profile, &next);
+    assert((size_t)((uintptr_t)next.end - (uintptr_t)next.base) >= 32 * ARL_KB);
+    arl_free(&next);
+    assert(profile->samples == 3);
+
+    // Persistence
+    assert(arl_profile_save(&set, "armel_profile_test.txt") == 1);
+    static ArlProfileSet loaded;
+    assert(arl_profile_load(&loaded, "armel_profile_test.txt") == 1);
+    remove("armel_profile_test.txt");
+    ArlProfile* again = arl_profile_get(&loaded, "request", 0);
+    assert(again->samples == 3);
+    assert(arl_profile_size(again) == arl_profile_size(profile));
+}
+
+
+static size_t soft_crossed;
+
+static void on_soft_limit (size_t used, void *ctx) {
+    (void)ctx;
+    soft_crossed = used;
+}
+
+ARMEL_TEST(test_arl_budget_limits) {
+    int parser = arl_budget_tag("parser");
+    assert(parser > 0 && arl_budget_tag("parser") == parser);
+    assert(strcmp(arl_budget_tag_name(parser), "parser") == 0);
+
+    size_t base = arl_budget_used();
+    arl_budget_set(base + 40 * ARL_KB, base + 64 * ARL_KB, on_soft_limit, NULL);
+    soft_crossed = 0;
+
+    int previous = arl_budget_use(parser);
+    Armel arena;
+    arl_new_custom(&arena, 16 * ARL_KB, ARL_ALIGN, ARL_SOFTFAIL);
+    arl_budget_use(previous);
+    arl_set_overflow_handler(&arena, arl_overflow_grow, NULL);
+    assert(arl_budget_tag_used(parser) == 16 * ARL_KB);
+    assert(soft_crossed == 0);
+
+    // Growth crosses the soft limit, then hits the hard one
+    assert(arl_alloc(&arena, 12 * ARL_KB) != NULL);
+    assert(arl_alloc(&arena, 20 * ARL_KB) != NULL);
+    assert(soft_crossed > base + 40 * ARL_KB);
+    assert(arl_alloc(&arena, 32 * ARL_KB) == NULL);
+    assert(arl_budget_refused() == 1);
+    assert(arl_budget_used() <= base + 64 * ARL_KB);
+
+    // Creation past the hard limit leaves an empty SOFTFAIL arena
+    Armel refused;
+    arl_new_custom(&refused, 64 * ARL_KB, ARL_ALIGN, ARL_SOFTFAIL);
+    assert(refused.base == NULL && arl_alloc(&refused, 8) == NULL);
+    arl_free(&refused);
+
+    // So does a mirrored ring
+    ArlMirror ring;
+    assert(arl_mirror_new(&ring, 64 * ARL_KB) == 0);
+    assert(ring.buffer == NULL && ring.capacity == 0);
+    arl_mirror_free(&ring);
+
+    // Cached blocks count until trimmed
+    arl_reset(&arena);
+    assert(arl_budget_tag_used(parser) > 16 * ARL_KB);
+    arl_trim(&arena);
+    assert(arl_budget_tag_used(parser) == 16 * ARL_KB);
+
+    arl_free(&arena);
+    assert(arl_budget_tag_used(parser) == 0);
+    assert(arl_budget_used() == base);
+    arl_budget_set(0, 0, NULL, NULL);
+
+    // Without a limit, a failure comes from the system
+    assert(arl_sys_try_alloc(SIZE_MAX / 2 + 1, 0) == NULL);
+    assert(arl_budget_refused() == 0);
+    assert(arl_budget_used() == base);
+
+    // Unknown tags (-1 from a full table) fall back to untagged
+    previous = arl_budget_use(-1);
+    assert(arl_budget_current() == 0);
+    arl_budget_use(ARL_BUDGET_TAGS + 5);
+    assert(arl_budget_current() == 0);
+    arl_budget_use(previous);
+    assert(arl_budget_tag_used(-1) == arl_budget_tag_used(0));
+}
+
+static void should_abort_on_budget() {
+    arl_budget_set(0, arl_budget_used() + ARL_KB, NULL, NULL);
+    Armel a;
+    arl_new(&a, 64 * ARL_KB);   // no ARL_SOFTFAIL: refusal aborts
+}
+
+ARMEL_TEST(test_arl_budget_abort) {
+    expect_abort(should_abort_on_budget, "arl_new: memory budget exceeded");
+}
+
+
+static void should_abort_on_ref_outside() {
+    Armel a;
+    arl_new(&a, 64);
+    (void)arl_ref_decode(&a, 1 + 64 / ARL_ALIGN);
+}
+
+static void should_abort_on_ref_overrun() {
+    typedef struct { uint8_t bytes[48]; } Big;
+    Armel a;
+    arl_new(&a, 64);
+    (void)ARL_DEREF_CHECKED(&a, Big, 1 + 32 / ARL_ALIGN);
+}
+
+ARMEL_TEST(test_arl_ref32_roundtrip) {
+    typedef struct { int key; arl_ref32 left, right; } Node;
+    Armel arena;
+    arl_new_custom(&arena, 4 * ARL_KB, 4, ARL_NOFLAG);
+
+    assert(arl_ref_encode(&arena, NULL) == ARL_REF_NULL);
+    assert(arl_ref_decode(&arena, ARL_REF_NULL) == NULL);
+
+    arl_ref32 root = arl_alloc_ref(&arena, sizeof(Node));
+    arl_ref32 child = arl_alloc_ref(&arena, sizeof(Node));
+    assert(root == 1 && child == 1 + sizeof(Node) / 4);
+
+    Node* node = ARL_DEREF(&arena, Node, root);
+    assert((void*)node == arena.base);
+    node->key = 1;
+    node->left = child;
+    node->right = ARL_REF_NULL;
+    ARL_DEREF(&arena, Node, child)->key = 2;
+
+    assert(ARL_DEREF(&arena, Node, node->left)->key == 2);
+    assert(ARL_REF(&arena, ARL_DEREF(&arena, Node, child)) == child);
+
+    // Memory outside the first block cannot be referenced
+    Armel grown;
+    arl_new(&grown, 64);
+    arl_set_overflow_handler(&grown, arl_overflow_grow, NULL);
+    arl_ref32 early = arl_alloc_ref(&grown, 32);
+    assert(early != ARL_REF_NULL);
+    memset(arl_ref_decode(&grown, early), 0x7E, 32);
+    assert(arl_alloc_ref(&grown, 128) == ARL_REF_NULL);
+
+    // References issued before the chain still decode into the first block
+    assert(grown.offset != 0);
+    assert(ARL_DEREF_CHECKED(&grown, Node, early) == grown.root);
+    assert(*(uint8_t*)arl_ref_decode(&grown, early) == 0x7E);
+    expect_abort(should_abort_on_ref_outside, "arl_ref_decode: reference outside the first block");
+    expect_abort(should_abort_on_ref_overrun, "ARL_DEREF_CHECKED: object past the first block");
+
+    arl_free(&grown);
+    arl_free(&arena);
+}
+
+ARMEL_TEST(test_arl_handle_pool) {
+    Armel arena;
+    ArlHandlePool pool;
+    arl_new_custom(&arena, 4 * ARL_KB, sizeof(int), ARL_NOFLAG);
+    assert(arl_handle_pool_new(&pool, &arena, sizeof(int), 4) == 1);
+
+    ArlHandle h[4];
+    for (int i = 0; i < 4; i++) {
+        h[i] = arl_handle_alloc(&pool);
+        assert(h[i] != ARL_HANDLE_NULL);
+        *(int*)arl_handle_get(&pool, h[i]) = i;
+    }
+    assert(arl_handle_alloc(&pool) == ARL_HANDLE_NULL);
+
+    // Swap-remove keeps the live objects dense and their handles valid
+    assert(arl_handle_free(&pool, h[1]) == 1);
+    assert(pool.count == 3);
+    assert(arl_handle_get(&pool, h[1]) == NULL);
+    assert(arl_handle_free(&pool, h[1]) == 0);
+    assert(*(int*)arl_handle_get(&pool, h[3]) == 3);
+    assert(((int*)arl_handle_items(&pool))[1] == 3);
+    assert(arl_handle_at(&pool, 1) == h[3]);
+
+    // A reused slot gets a new generation: the stale handle stays dead
+    ArlHandle again = arl_handle_alloc(&pool);
+    assert((again & ARL_HANDLE_INDEX_MASK) == (h[1] & ARL_HANDLE_INDEX_MASK));
+    assert(again != h[1]);
+    assert(arl_handle_get(&pool, h[1]) == NULL);
+    assert(arl_handle_get(&pool, again) == (int*)arl_handle_items(&pool) + 3);
+    assert(pool.count == 4);
+
+    arl_free(&arena);
+}
+
+ARMEL_TEST(test_arl_handle_retire) {
+    Armel arena;
+    ArlHandlePool pool;
+    arl_new_custom(&arena, 4 * ARL_KB, sizeof(int), ARL_NOFLAG);
+    assert(arl_handle_pool_new(&pool, &arena, sizeof(int), 2) == 1);
+
+    // Fast-forward slot 0 to its last generation instead of freeing it 2^k times
+    ArlHandle first = arl_handle_alloc(&pool);
+    uint32_t index = (uint32_t)(first & ARL_HANDLE_INDEX_MASK);
+    pool.slots[index].generation = (uint32_t)ARL_HANDLE_GEN_MASK;
+    ArlHandle last = arl_handle_at(&pool, 0);
+    assert(arl_handle_get(&pool, last) != NULL);
+
+    // Its last free retires the slot: no generation wrap, no reuse
+    assert(arl_handle_free(&pool, last) == 1);
+    assert(pool.retired == 1);
+    assert(arl_handle_get(&pool, last) == NULL);
+    assert(arl_handle_get(&pool, (ArlHandle)index) == NULL);
+    assert(arl_handle_free(&pool, (ArlHandle)index) == 0);
+
+    ArlHandle other = arl_handle_alloc(&pool);
+    assert(other != ARL_HANDLE_NULL);
+    assert((other & ARL_HANDLE_INDEX_MASK) != index);
+
+    // The retired slot costs capacity: nothing left once the other slot is live
+    assert(arl_handle_alloc(&pool) == ARL_HANDLE_NULL);
+    assert(arl_handle_free(&pool, other) == 1);
+    assert((arl_handle_alloc(&pool) & ARL_HANDLE_INDEX_MASK) == (other & ARL_HANDLE_INDEX_MASK));
+
+    arl_free(&arena);
+}
+
+ARMEL_TEST(test_arl_bitmap_lowest_slot) {
+    Armel arena;
+    ArlBitmap pool;
+    arl_new(&arena, 64 * ARL_KB);
+    arl_bitmap_new(&pool, &arena, 48, ARL_KB);
+
+    char* a = arl_bitmap_alloc(&pool);
+    char* b = arl_bitmap_alloc(&pool);
+    char* c = arl_bitmap_alloc(&pool);
+    assert(((uintptr_t)a & (ARL_KB - 1)) == pool.header);
+    assert(b == a + 48 && c == b + 48);
+
+    // The lowest free slot is reused first, not the last one freed
+    arl_bitmap_free(&pool, a);
+    arl_bitmap_free(&pool, c);
+    assert(arl_bitmap_alloc(&pool) == a);
+    assert(arl_bitmap_alloc(&pool) == c);
+
+    // Fill the first page, spill into a second one
+    while (pool.current->live < pool.slots) arl_bitmap_alloc(&pool);
+    char* spill = arl_bitmap_alloc(&pool);
+    assert(((uintptr_t)spill & ~(uintptr_t)(ARL_KB - 1)) != ((uintptr_t)a & ~(uintptr_t)(ARL_KB - 1)));
+
+    // A full page that gets a free slot becomes partial, then is reused
+    arl_bitmap_free(&pool, b);
+    assert(pool.partial != NULL);
+    void* end = arena.cursor;
+
+    // The empty last page goes back to the arena
+    arl_bitmap_free(&pool, spill);
+    assert(pool.current->live == 0);
+    while (pool.current->live < pool.slots) arl_bitmap_alloc(&pool);
+    assert(arl_bitmap_alloc(&pool) == b);
+    assert(pool.partial == NULL);
+    for (uint32_t i = 0; i < pool.slots; i++) {
+        arl_bitmap_free(&pool, spill + i * 48);
+    }
+    assert(arena.cursor < end);
+
+    arl_free(&arena);
+}
+
+ARMEL_TEST(test_arl_buddy_split_merge) {
+    Armel arena;
+    ArlBuddy buddy;
+    arl_new(&arena, ARL_MB);
+    assert(arl_buddy_new(&buddy, &arena, 64 * ARL_KB, 4 * ARL_KB) == 1);
+    assert(((uintptr_t)buddy.base & (4 * ARL_KB - 1)) == 0);
+    assert(buddy.free[4] != NULL && buddy.free[0] == NULL);
+
+    // Splitting 64 KB leaves one free block at each smaller order
+    char* a = arl_buddy_alloc(&buddy, 100);
+    char* b = arl_buddy_alloc(&buddy, 5000);
+    assert(a == (char*)buddy.base);
+    assert(b == a + 8 * ARL_KB);
+    assert(arl_buddy_block_size(5000) == 8 * ARL_KB);
+    assert(buddy.available == 64 * ARL_KB - 12 * ARL_KB);
+    assert(arl_buddy_alloc(&buddy, 64 * ARL_KB) == NULL);
+
+    // Freeing both merges everything back into one block
+    arl_buddy_free(&buddy, a, 100);
+    arl_buddy_free(&buddy, b, 5000);
+    assert(buddy.available == 64 * ARL_KB);
+    assert(buddy.free[4] != NULL && buddy.free[0] == NULL && buddy.free[3] == NULL);
+    assert(arl_buddy_alloc(&buddy, 64 * ARL_KB) == a);
+
+    // A dedicated mapping that is not a power of 2 is covered by several blocks
+    ArlBuddy mapped;
+    assert(arl_buddy_new_mapped(&mapped, 12 * ARL_KB) == 1);
+    void* x = arl_buddy_alloc(&mapped, 8 * ARL_KB);
+    void* y = arl_buddy_alloc(&mapped, 4 * ARL_KB);
+    assert(x != NULL && y != NULL && arl_buddy_alloc(&mapped, 4 * ARL_KB) == NULL);
+    arl_buddy_free(&mapped, y, 4 * ARL_KB);
+    arl_buddy_free(&mapped, x, 8 * ARL_KB);
+    assert(mapped.available == 12 * ARL_KB);
+    arl_buddy_destroy(&mapped);
+
+    arl_free(&arena);
+}
+
+ARMEL_TEST(test_arl_read_file_slices) {
+    const char* path = "armel_test_file.txt";
+    const char* text = "alpha\r\nbeta\n\ngamma";
+    FILE* file = fopen(path, "wb");
+    assert(file != NULL);
+    fwrite(text, 1, strlen(text), file);
+    fclose(file);
+
+    Armel arena;
+    arl_new(&arena, 64 * ARL_KB);
+
+    ArlFileMode modes[] = { ARL_FILE_AUTO, ARL_FILE_READ, ARL_FILE_MAP, ARL_FILE_DIRECT };
+    for (int m = 0; m < 4; m++) {
+        size_t len = 0;
+        const char* data = arl_read_file_mode(&arena, path, &len, modes[m]);
+        assert(data != NULL && len == strlen(text));
+        assert(memcmp(data, text, len) == 0);
+
+        // Lines point into the buffer, without their line endings
+        ArlSlice rest = { data, len }, line;
+        assert(arl_next_line(&rest, &line) && line.ptr == data && line.len == 5);
+        assert(arl_next_line(&rest, &line) && line.len == 4 && memcmp(line.ptr, "beta", 4) == 0);
+        assert(arl_next_line(&rest, &line) && line.len == 0);
+        assert(arl_next_line(&rest, &line) && line.len == 5 && memcmp(line.ptr, "gamma", 5) == 0);
+        assert(!arl_next_line(&rest, &line));
+    }
+
+    ArlSlice rest = { "abcdefg", 7 }, record;
+    assert(arl_next_fixed(&rest, 3, &record) && record.len == 3);
+    assert(arl_next_fixed(&rest, 3, &record) && record.len == 3);
+    assert(arl_next_fixed(&rest, 3, &record) && record.len == 1 && *record.ptr == 'g');
+    assert(!arl_next_fixed(&rest, 3, &record));
+
+    size_t len;
+    assert(arl_read_file(&arena, "armel_missing_file.txt", &len) == NULL);
+
+    arl_free(&arena);
+    remove(path);
+
+#ifndef _WIN32
+    // A FIFO has no size: it is read to the end, growing the buffer in place then by moving it
+    const char* fifo = "armel_test_fifo";
+    remove(fifo);
+    assert(mkfifo(fifo, 0600) == 0);
+    pid_t writer = fork();
+    if (writer == 0) {
+        FILE* out = fopen(fifo, "wb");
+        for (int i = 0; i < 20000; i++) fputc('a' + i % 26, out);
+        fclose(out);
+        _exit(0);
+    }
+
+    Armel small;
+    arl_new(&small, 16 * ARL_KB);
+    arl_set_overflow_handler(&small, arl_overflow_grow, NULL);
+    const char* streamed = arl_read_file(&small, fifo, &len);
+    waitpid(writer, NULL, 0);
+    assert(streamed != NULL && len == 20000 && streamed[len] == '\0');
+    for (int i = 0; i < 20000; i++) assert(streamed[i] == 'a' + i % 26);
+    arl_free(&small);
+    remove(fifo);
+#endif
+
+#if defined(__linux__)
+    // procfs reports a size of 0
+    Armel proc;
+    arl_new(&proc, 64 * ARL_KB);
+    const char* status = arl_read_file(&proc, "/proc/self/status", &len);
+    assert(status != NULL && len > 0 && strncmp(status, "Name:", 5) == 0);
+    arl_free(&proc);
+#endif
+}
+
+#if defined(__linux__)
+static void should_abort_on_pinned_reset() {
+    Armel arena;
+    ArlOutput out;
+    int fds[2];
+    assert(pipe(fds) == 0);
+    arl_new(&arena, 64 * ARL_KB);
+    arl_output_init(&out);
+    arl_output_add(&out, arl_alloc(&arena, 64), 64);
+    arl_output_splice(&out, &arena, fds[1]);
+    arl_reset(&arena);   // the pipe still references the arena
+}
+
+static void should_abort_on_second_arena_reset() {
+    Armel first, second;
+    ArlOutput out;
+    int fds[2];
+    assert(pipe(fds) == 0);
+    arl_new(&first, 64 * ARL_KB);
+    arl_new(&second, 64 * ARL_KB);
+    arl_output_init(&out);
+    arl_output_add(&out, arl_alloc(&first, 64), 64);
+    arl_output_splice(&out, &first, fds[1]);
+    arl_output_add(&out, arl_alloc(&second, 64), 64);
+    arl_output_splice(&out, &second, fds[1]);
+    arl_reset(&second);  // its pages are in the pipe too
+}
+
+static void should_abort_on_old_pipe() {
+    Armel arena;
+    ArlOutput out;
+    int a[2], b[2];
+    char sink[64];
+    assert(pipe(a) == 0 && pipe(b) == 0);
+    arl_new(&arena, 64 * ARL_KB);
+    arl_output_init(&out);
+    arl_output_add(&out, arl_alloc(&arena, 64), 64);
+    arl_output_splice(&out, &arena, a[1]);
+    arl_output_add(&out, arl_alloc(&arena, 64), 64);
+    arl_output_splice(&out, &arena, b[1]);
+    assert(read(b[0], sink, sizeof(sink)) == 64);
+    arl_reset(&arena);   // the first pipe still holds data
+}
+
+static void should_abort_on_pinned_rewind() {
+    Armel arena;
+    ArlOutput out;
+    int fds[2];
+    char sink[64];
+    assert(pipe(fds) == 0);
+    arl_new(&arena, 64 * ARL_KB);
+    arl_output_init(&out);
+    arl_output_add(&out, arl_alloc(&arena, 64), 64);
+    arl_output_splice(&out, &arena, fds[1]);
+    assert(read(fds[0], sink, sizeof(sink)) == 64);
+    uintptr_t mark = arl_offset(&arena);
+    arl_output_add(&out, arl_alloc(&arena, 64), 64);
+    arl_output_splice(&out, &arena, fds[1]);
+    arl_unwind(&arena, mark);   // frees pages still in the pipe
+}
+#endif
+
+ARMEL_TEST(test_arl_output_gather) {
+#ifndef _WIN32
+    Armel arena;
+    ArlOutput out;
+    int fds[2];
+    char received[32] = {0};
+    assert(pipe(fds) == 0);
+    arl_new(&arena, 64 * ARL_KB);
+
+    char* hello = arl_alloc(&arena, 5);
+    char* world = arl_alloc(&arena, 6);
+    memcpy(hello, "hello", 5);
+    memcpy(world, " world", 6);
+
+    arl_output_init(&out);
+    assert(arl_output_add(&out, hello, 5) && arl_output_add(&out, world, 6));
+    assert(arl_output_add(&out, world, 0) && out.count == 2);
+    assert(arl_output_write(&out, fds[1]) == 11 && out.bytes == 0);
+    assert(read(fds[0], received, sizeof(received)) == 11);
+    assert(memcmp(received, "hello world", 11) == 0);
+
+#if defined(__linux__)
+    // Spliced pages pin the arena until the pipe is drained
+    arl_output_init(&out);
+    arl_output_add(&out, hello, 5);
+    arl_output_add(&out, world, 6);
+    assert(arl_output_splice(&out, &arena, fds[1]) == 11);
+    assert(!arl_output_drained(&out));
+    assert(read(fds[0], received, sizeof(received)) == 11);
+    assert(arl_output_drained(&out));
+    assert(memcmp(received, "hello world", 11) == 0);
+
+    // A reset with an empty pipe clears the pin, even if drained was never asked
+    arl_output_init(&out);
+    char* page = arl_alloc(&arena, 8);
+    memcpy(page, "spliced", 8);
+    arl_output_add(&out, page, 8);
+    assert(arl_output_splice(&out, &arena, fds[1]) == 8 && out.pin != NULL);
+    assert(read(fds[0], received, sizeof(received)) == 8);
+    arl_reset(&arena);
+    assert(out.pin == NULL && arl_output_drained(&out));
+
+    // An explicit release unpins while data is still in flight
+    page = arl_alloc(&arena, 8);
+    arl_output_add(&out, page, 8);
+    assert(arl_output_splice(&out, &arena, fds[1]) == 8);
+    assert(!arl_output_drained(&out));
+    arl_output_release(&out);
+    assert(out.pin == NULL);
+    assert(read(fds[0], received, sizeof(received)) == 8);
+
+    // Pins from several splices are tracked until every pipe is empty
+    int other[2];
+    assert(pipe(other) == 0);
+    page = arl_alloc(&arena, 8);
+    arl_output_add(&out, page, 8);
+    assert(arl_output_splice(&out, &arena, fds[1]) == 8);
+    page = arl_alloc(&arena, 8);
+    arl_output_add(&out, page, 8);
+    assert(arl_output_splice(&out, &arena, other[1]) == 8);
+    assert(out.pin != NULL && out.pin->next != NULL);
+    assert(read(other[0], received, sizeof(received)) == 8);
+    assert(!arl_output_drained(&out) && out.pin != NULL && out.pin->next == NULL);
+    assert(read(fds[0], received, sizeof(received)) == 8);
+    assert(arl_output_drained(&out) && out.pin == NULL);
+    assert(arl_output_splice(&out, &arena, fds[1]) == 0 && out.pin == NULL);
+    close(other[0]);
+    close(other[1]);
+
+    expect_abort(should_abort_on_pinned_reset, "arl_reset: spliced pages still in a pipe");
+    expect_abort(should_abort_on_second_arena_reset, "arl_reset: pages of a second arena in the pipe");
+    expect_abort(should_abort_on_old_pipe, "arl_reset: previous pipe still holds data");
+    expect_abort(should_abort_on_pinned_rewind, "arl_unwind: spliced pages past the mark");
+#endif
+
+    arl_free(&arena);
+    close(fds[0]);
+    close(fds[1]);
+#endif
+}
+
+typedef struct CloneNode {
+    struct CloneNode* next;
+    char* name;
+    double weight;
+} CloneNode;
+
+static void relocate_clone_node(ArlClone* clone, void* object) {
+    CloneNode* node = object;
+    arl_clone_ref(clone, &node->next, sizeof(CloneNode), _Alignof(CloneNode), relocate_clone_node);
+    arl_clone_ref(clone, &node->name, strlen(node->name) + 1, 1, NULL);
+}
+
+ARMEL_TEST(test_arl_clone_graph) {
+    Armel scratch;
+    arl_new(&scratch, 64 * ARL_KB);
+
+    // A 3-node cycle sharing one name, among temporaries
+    char* shared = arl_alloc(&scratch, 6);
+    memcpy(shared, "shard", 6);
+    CloneNode* nodes[3];
+    for (int i = 0; i < 3; i++) {
+        arl_alloc(&scratch, 1000);
+        nodes[i] = arl_make(&scratch, CloneNode);
+        nodes[i]->name = shared;
+        nodes[i]->weight = i;
+    }
+    for (int i = 0; i < 3; i++) nodes[i]->next = nodes[(i + 1) % 3];
+
+    Armel kept;
+    CloneNode* copy = arl_clone_new(&kept, &scratch, nodes[0], sizeof(CloneNode), _Alignof(CloneNode), relocate_clone_node);
+    assert(copy != NULL);
+    assert(arl_used(&kept) < 3 * sizeof(CloneNode) + 6 + _Alignof(CloneNode));
+
+    // The scratch arena can go: the copy only points into itself
+    memset(scratch.base, 0xAB, arl_used(&scratch));
+    arl_reset(&scratch);
+
+    assert(copy->next->next->next == copy);
+    for (int i = 0; i < 3; i++, copy = copy->next) {
+        assert(copy->weight == i);
+        assert(strcmp(copy->name, "shard") == 0);
+        assert(copy->name == copy->next->name);
+        assert((char*)copy >= (char*)kept.base && (char*)copy < (char*)kept.end);
+    }
+
+    // Cloning into an existing arena packs the graph in one allocation
+    CloneNode* leaf = arl_make(&scratch, CloneNode);
+    leaf->next = NULL;
+    leaf->name = arl_clone_range(&scratch, "leaf", 5);
+    Armel cache;
+    arl_new(&cache, 4 * ARL_KB);
+    CloneNode* again = arl_clone(&cache, &scratch, leaf, sizeof(CloneNode), _Alignof(CloneNode), relocate_clone_node);
+    assert(again != leaf && again->next == NULL && strcmp(again->name, "leaf") == 0);
+    assert(again->name == (char*)(again + 1));
+
+    // Nothing to clone: the arena is still safe to free
+    Armel empty;
+    memset(&empty, 0xAB, sizeof(empty));
+    assert(arl_clone_new(&empty, &scratch, NULL, sizeof(CloneNode), _Alignof(CloneNode), relocate_clone_node) == NULL);
+    arl_free(&empty);
+
+    arl_free(&cache);
+    arl_free(&kept);
+    arl_free(&scratch);
+}
+
+typedef struct GcEntry {
+    struct GcEntry* next;
+    char* key;
+    int value;
+} GcEntry;
+
+static void trace_gc_entry(ArlGc* gc, void* object) {
+    GcEntry* entry = object;
+    arl_gc_relocate(gc, &entry->next);
+    arl_gc_relocate(gc, &entry->key);
+}
+
+static const ArlGcType gc_entry_type = { sizeof(GcEntry), trace_gc_entry };
+static const ArlGcType gc_bytes_type = { 0, NULL };
+
+static void should_abort_on_interior_root() {
+    ArlGc gc;
+    arl_gc_new(&gc, ARL_KB);
+    GcEntry* entry = arl_gc_alloc(&gc, &gc_entry_type, 0);
+    memset(entry, 0, sizeof(*entry));
+    entry->value = 42;
+    int* inside = &entry->value;   // interior pointer: its "header" is the entry's fields
+    arl_gc_root(&gc, &inside);
+    arl_collect(&gc);
+}
+
+ARMEL_TEST(test_arl_gc_collect) {
+    ArlGc gc;
+    arl_gc_new(&gc, 64 * ARL_KB);
+
+    // A live cycle of 4 entries sharing one key; every other entry is garbage
+    GcEntry* head = NULL;
+    GcEntry* tail = NULL;
+    char* key = arl_gc_alloc(&gc, &gc_bytes_type, 4);
+    memcpy(key, "key", 4);
+    assert(arl_gc_alloc(&gc, &gc_bytes_type, SIZE_MAX - 4) == NULL);   // header would wrap
+    assert(arl_gc_root(&gc, &head));
+    for (int i = 0; i < 8; i++) {
+        GcEntry* entry = arl_gc_alloc(&gc, &gc_entry_type, 0);
+        entry->key = key;
+        entry->value = i;
+        entry->next = NULL;
+        if (i % 2) continue;
+        if (tail) tail->next = entry; else head = entry;
+        tail = entry;
+    }
+    tail->next = head;
+    const char* outside = "static";
+    head->key = (char*)outside;
+
+    Armel* old = &gc.spaces[gc.current];
+    size_t before = arl_used(old);
+    ArlGcStats stats = arl_collect(&gc);
+
+    // Live: 4 entries + key, one header each (plus alignment padding between copies)
+    size_t live = 5 * sizeof(ArlGcHeader) + 4 * sizeof(GcEntry) + 4;
+    assert(stats.objects == 5);
+    assert(stats.copied >= live && stats.copied < live + 5 * sizeof(ArlGcHeader));
+    assert(stats.copied == arl_used(&gc.spaces[gc.current]));
+    assert(stats.reclaimed == before - stats.copied);
+    live = stats.copied;
+    assert(arl_used(old) == 0 && gc.collections == 1);
+
+    GcEntry* entry = head;
+    for (int i = 0; i < 4; i++, entry = entry->next) {
+        assert(entry->value == 2 * i);
+        assert((char*)entry >= (char*)gc.spaces[gc.current].base && (char*)entry < (char*)gc.spaces[gc.current].end);
+    }
+    assert(entry == head);
+    assert(head->key == outside);
+    assert(strcmp(head->next->key, "key") == 0 && head->next->key == head->next->next->key);
+
+    // Nothing died: a second collection copies everything back
+    stats = arl_collect(&gc);
+    assert(stats.copied == live && stats.reclaimed == 0);
+    assert(head->next->next->next->next == head && head->next->value == 2);
+
+    // A full semi-space returns NULL until collected
+    arl_gc_unroot(&gc, &head);
+    while (arl_gc_alloc(&gc, &gc_bytes_type, 1000) != NULL) {}
+    stats = arl_collect(&gc);
+    assert(stats.copied == 0 && stats.objects == 0);
+    assert(arl_gc_alloc(&gc, &gc_bytes_type, 1000) != NULL);
+
+    expect_abort(should_abort_on_interior_root, "arl_gc_relocate: interior pointer");
+
+    arl_gc_free(&gc);
+}
+
+ARMEL_TEST(test_arl_prefault) {
+    // 4 slices of ARL_PREFAULT_SLICE, zeroed by the fresh mapping
+    Armel arena;
+    arl_new_prefault(&arena, 4 * ARL_PREFAULT_SLICE, 64, ARL_ZEROS, 4, ARL_NUMA_ANY);
+    assert(arena.flags == ARL_ZEROS);
+    uint8_t* bytes = arena.base;
+    for (size_t i = 0; i < 4 * ARL_PREFAULT_SLICE; i += 4096) assert(bytes[i] == 0);
+
+    // Touching keeps the content; zero-filling clears an odd-sized range, pinned to node 0
+    memset(bytes, 0x5A, 3 * ARL_PREFAULT_SLICE + 123);
+    assert(arl_prefault(bytes, 4 * ARL_PREFAULT_SLICE, ARL_PREFAULT_TOUCH, 0, ARL_NUMA_ANY) >= 1);
+    assert(bytes[0] == 0x5A && bytes[3 * ARL_PREFAULT_SLICE + 122] == 0x5A);
+    assert(arl_prefault(bytes, 3 * ARL_PREFAULT_SLICE + 123, ARL_PREFAULT_ZERO, 3, 0) == 3);
+    for (size_t i = 0; i < 3 * ARL_PREFAULT_SLICE + 123; i++) assert(bytes[i] == 0);
+
+    // Too small to split: the calling thread does it
+    assert(arl_prefault(bytes, 4096, ARL_PREFAULT_ZERO, 8, ARL_NUMA_ANY) == 1);
+
+    arl_free(&arena);
+}
+
 // ------------------------------------------------------------------------------------- //
 
 int main (void) {
@@ -474,6 +1866,38 @@ int main (void) {
 	RUN_TEST(test_zero_alignment_abort);
 	RUN_TEST(test_arl_alloc_overflow_abort);
 	RUN_TEST(test_arl_alloc_softfail_null);
+	RUN_TEST(test_arl_overflow_grow);
+	RUN_TEST(test_arl_overflow_malloc);
+	RUN_TEST(test_arl_overflow_parent);
+	RUN_TEST(test_arl_overflow_custom);
+	RUN_TEST(test_arl_overflow_abort_policy);
+	RUN_TEST(test_arl_large_bypass);
+	RUN_TEST(test_arl_cache_best_fit);
+	RUN_TEST(test_arl_epoch_reclaim);
+	RUN_TEST(test_arl_frame_rotation);
+	RUN_TEST(test_arl_frame_adaptive);
+	RUN_TEST(test_arl_ring_fifo);
+	RUN_TEST(test_arl_mirror_wrap);
+	RUN_TEST(test_arl_log_publication);
+	RUN_TEST(test_arl_mpsc_recycle);
+	RUN_TEST(test_arl_detach_attach);
+	RUN_TEST(test_arl_detach_unaligned_abort);
+	RUN_TEST(test_arl_pool_remote_free);
+	RUN_TEST(test_arl_defer_lifo);
+	RUN_TEST(test_arl_detach_defer_order);
+	RUN_TEST(test_arl_profile_sizing);
+	RUN_TEST(test_arl_budget_limits);
+	RUN_TEST(test_arl_budget_abort);
+	RUN_TEST(test_arl_ref32_roundtrip);
+	RUN_TEST(test_arl_handle_pool);
+	RUN_TEST(test_arl_handle_retire);
+	RUN_TEST(test_arl_bitmap_lowest_slot);
+	RUN_TEST(test_arl_buddy_split_merge);
+	RUN_TEST(test_arl_read_file_slices);
+	RUN_TEST(test_arl_output_gather);
+	RUN_TEST(test_arl_clone_graph);
+	RUN_TEST(test_arl_gc_collect);
+	RUN_TEST(test_arl_prefault);
 
 	RUN_TEST(test_arl_print_info);
 	// 
@@ -0,0 +1,209 @@
+#include <Armel/armel_test.h>
+#include <Armel/armel.hpp>
+
+#include <string>
+#include <vector>
+
+struct Point {
+	Point (int x, int y) : x(x), y(y) {}
+	int x, y;
+};
+
+struct alignas(64) Wide {
+	char bytes[64];
+};
+
+ARMEL_TEST(test_hpp_resource_containers) {
+	armel::Arena arena(ARL_KB * 64);
+	armel::Resource resource(arena);
+
+	std::pmr::vector<int> values(&resource);
+	for (int i = 0; i < 1000; i++) values.push_back(i);
+	assert(values[999] == 999);
+
+	std::pmr::string name("a string long enough to leave the small buffer", &resource);
+	assert(name.size() > 40);
+
+	uintptr_t data = reinterpret_cast<uintptr_t>(values.data());
+	assert(data >= reinterpret_cast<uintptr_t>(arena.get()->base));
+	assert(data < reinterpret_cast<uintptr_t>(arena.get()->end));
+}
+
+ARMEL_TEST(test_hpp_lifo_pop) {
+	armel::Arena arena(ARL_KB);
+
+	uintptr_t before = arl_offset(arena);
+	void* last = armel::allocate(arena, 100, alignof(int));
+	assert(armel::pop(arena, last, 100));
+	assert(arl_offset(arena) == before);
+
+	void* first = armel::allocate(arena, 32, alignof(int));
+	(void)armel::allocate(arena, 32, alignof(int));
+	assert(!armel::pop(arena, first, 32));   // not the most recent allocation
+}
+
+ARMEL_TEST(test_hpp_allocator_and_make) {
+	armel::Arena arena(ARL_KB * 64);
+
+	std::vector<int, armel::Allocator<int>> values{armel::Allocator<int>(arena)};
+	values.assign(100, 7);
+	assert(values.size() == 100 && values[99] == 7);
+	assert(armel::Allocator<int>(arena) == armel::Allocator<long>(arena));
+
+	Point* p = armel::make<Point>(arena, 1, 2);
+	assert(p->x == 1 && p->y == 2);
+
+	Wide* w = armel::make<Wide>(arena);
+	assert(reinterpret_cast<uintptr_t>(w) % 64 == 0);
+}
+
+struct Counted {
+	explicit Counted (int *count) : count(count) {}
+	~Counted () { ++*count; }
+	int *count;
+};
+
+ARMEL_TEST(test_hpp_make_destroys) {
+	int destroyed = 0;
+	armel::Arena arena(ARL_KB);
+
+	{
+		armel::Scope scope(arena);
+		(void)armel::make<Counted>(arena, &destroyed);
+		(void)armel::make<Counted>(arena, &destroyed);
+	}
+	assert(destroyed == 2);
+
+	(void)armel::make<Counted>(arena, &destroyed);
+	arena.reset();
+	assert(destroyed == 3);
+}
+
+ARMEL_TEST(test_hpp_scope_rewind) {
+	armel::Arena arena(ARL_KB);
+	(void)arl_alloc(arena, 16);
+	uintptr_t mark = arl_offset(arena);
+
+	{
+		armel::Scope scope(arena);
+		(void)arl_alloc(arena, 256);
+		assert(arl_offset(arena) > mark);
+	}
+	assert(arl_offset(arena) == mark);
+}
+
+ARMEL_TEST(test_hpp_softfail_throws) {
+	armel::Arena arena(64, ARL_ALIGN, ARL_SOFTFAIL);
+	bool thrown = false;
+
+	try {
+		(void)armel::make<Wide>(arena);
+		(void)armel::allocate(arena, 1024, alignof(int));
+	} catch (const std::bad_alloc&) {
+		thrown = true;
+	}
+	assert(thrown);
+}
+
+#if defined(__cpp_impl_coroutine)
+
+#include <exception>
+
+// GCC pairs the frame's operator delete with the wrong operator new when the
+// coroutine takes its arena as an argument (false positive)
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Minimal lazy task, resumed by its awaiter through symmetric transfer
+struct Task {
+	struct promise_type : armel::Frames {
+		int value = 0;
+		std::coroutine_handle<> continuation;
+
+		Task get_return_object () { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+		std::suspend_always initial_suspend () noexcept { return {}; }
+		void return_value (int v) { value = v; }
+		void unhandled_exception () { std::terminate(); }
+
+		struct Final {
+			bool await_ready () noexcept { return false; }
+			std::coroutine_handle<> await_suspend (std::coroutine_handle<promise_type> h) noexcept {
+				std::coroutine_handle<> next = h.promise().continuation;
+				return next ? next : std::noop_coroutine();
+			}
+			void await_resume () noexcept {}
+		};
+		Final final_suspend () noexcept { return {}; }
+	};
+
+	explicit Task (std::coroutine_handle<promise_type> h) : handle(h) {}
+	Task (Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+	~Task () { if (handle) handle.destroy(); }
+
+	bool await_ready () { return false; }
+	std::coroutine_handle<> await_suspend (std::coroutine_handle<> c) {
+		handle.promise().continuation = c;
+		return handle;
+	}
+	int await_resume () { return handle.promise().value; }
+
+	int run () {
+		handle.resume();
+		return handle.promise().value;
+	}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+static Task chain (int depth) {
+	if (depth == 0) co_return 0;
+	co_return 1 + co_await chain(depth - 1);
+}
+
+static Task in_arena (Armel*, int x) {
+	co_return x;
+}
+
+ARMEL_TEST(test_hpp_coroutine_frames) {
+	armel::Arena arena(ARL_KB * 64);
+	uintptr_t before = arl_offset(arena);
+
+	{
+		armel::FrameScope frames(arena);
+		Task task = chain(16);
+		assert(arl_offset(arena) > before);
+		assert(task.run() == 16);
+	}
+	// Frames died in stack order: every one was popped
+	assert(arl_offset(arena) == before);
+
+	Task task = in_arena(arena, 7);
+	uintptr_t frame = reinterpret_cast<uintptr_t>(task.handle.address());
+	assert(frame >= reinterpret_cast<uintptr_t>(arena.get()->base));
+	assert(frame < reinterpret_cast<uintptr_t>(arena.get()->end));
+	assert(task.run() == 7);
+
+	// Without an arena, frames come from the heap
+	Task heap = chain(2);
+	assert(arl_offset(arena) > before);
+	assert(heap.run() == 2);
+}
+
+#endif
+
+// ------------------------------------------------------------------------------------- //
+
+int main (void) {
+	RUN_TEST(test_hpp_resource_containers);
+	RUN_TEST(test_hpp_lifo_pop);
+	RUN_TEST(test_hpp_allocator_and_make);
+	RUN_TEST(test_hpp_make_destroys);
+	RUN_TEST(test_hpp_scope_rewind);
+	RUN_TEST(test_hpp_softfail_throws);
+#if defined(__cpp_impl_coroutine)
+	RUN_TEST(test_hpp_coroutine_frames);
+#endif
+
+	return 0;
+}